@@ -0,0 +1,126 @@
+#include "AdaaTanh.h"
+
+namespace {
+constexpr double ln2 = 0.69314718055994530942;
+constexpr double pi2Over24 = 0.41123351671205660911; // Li2(-1) = -pi^2 / 12
+
+// Below these steps the divided differences lose too many digits and the
+// midpoint fallbacks (accurate to the square of the step) take over
+constexpr double firstOrderTolerance = 1.0e-5;
+constexpr double secondOrderTolerance = 1.0e-3;
+
+struct Antiderivatives {
+  double f1; // log(cosh(x))
+  double f2; // Integral of log(cosh), odd, zero at 0
+};
+
+// Both antiderivatives from one exp and one log1p. With a = |x| and
+// u = exp(-2a): log(cosh(a)) = a - ln2 + log1p(u), and its integral is
+// a^2 / 2 - a ln2 + Li2(-u) / 2 + pi^2 / 24.
+Antiderivatives antiderivatives(double x) {
+  const double a = std::abs(x);
+  const double l = std::log1p(std::exp(-2.0 * a));
+
+  // Li2(z) = sum B_n t^(n+1) / (n+1)! with t = -log(1 - z); here |t| <= ln2,
+  // so five terms are good to about 1e-9
+  const double t = -l;
+  const double t2 = t * t;
+  const double li2 =
+      t * (1.0 + t * (-0.25 + t * (1.0 / 36.0 +
+                                   t2 * (-1.0 / 3600.0 + t2 / 211680.0))));
+
+  const double f2 = 0.5 * a * a - a * ln2 + 0.5 * li2 + pi2Over24;
+  return {a - ln2 + l, x < 0.0 ? -f2 : f2};
+}
+
+double logCosh(double x) {
+  const double a = std::abs(x);
+  return a - ln2 + std::log1p(std::exp(-2.0 * a));
+}
+} // namespace
+
+void AdaaTanh::setOrder(Order newOrder) {
+  if (newOrder == order)
+    return;
+
+  order = newOrder;
+  reset();
+}
+
+void AdaaTanh::reset() {
+  for (auto &lane : lanes)
+    lane = Lane();
+}
+
+float AdaaTanh::getLatency() const {
+  switch (order) {
+  case Order::First:
+    return 0.5f;
+  case Order::Second:
+    return 1.0f;
+  default:
+    return 0.0f;
+  }
+}
+
+StereoFrame AdaaTanh::processFrame(StereoFrame frame, int numChannels) {
+  // The lanes branch on their own step sizes and call scalar libm, so they
+  // run one at a time
+  const float left = processLane(lanes[0], (double)frame.left());
+  if (numChannels < 2)
+    return left;
+  return {left, processLane(lanes[1], (double)frame.right())};
+}
+
+float AdaaTanh::processSample(int channel, float x) {
+  return processLane(lanes[(size_t)juce::jlimit(0, numLanes - 1, channel)],
+                     (double)x);
+}
+
+float AdaaTanh::processLane(Lane &lane, double x) const {
+  if (order == Order::Off)
+    return (float)std::tanh(x);
+
+  const auto ad = antiderivatives(x);
+
+  if (!lane.primed) {
+    // Start from a flat history at this input
+    lane = {x, x, ad.f1, ad.f2, ad.f1, true};
+    return (float)std::tanh(x);
+  }
+
+  double y;
+  if (order == Order::First) {
+    const double dx = x - lane.x1;
+    y = std::abs(dx) > firstOrderTolerance ? (ad.f1 - lane.f1) / dx
+                                           : std::tanh(0.5 * (x + lane.x1));
+  } else {
+    const double dx = x - lane.x1;
+    const double d1 = std::abs(dx) > firstOrderTolerance
+                          ? (ad.f2 - lane.f2) / dx
+                          : logCosh(0.5 * (x + lane.x1));
+
+    const double dx2 = x - lane.x2;
+    if (std::abs(dx2) > secondOrderTolerance) {
+      y = 2.0 * (d1 - lane.d1) / dx2;
+    } else {
+      // x and x2 (nearly) coincide: expand around their midpoint instead
+      const double mid = 0.5 * (x + lane.x2);
+      const double delta = mid - lane.x1;
+      if (std::abs(delta) > secondOrderTolerance) {
+        const auto adMid = antiderivatives(mid);
+        y = 2.0 / delta * (adMid.f1 + (lane.f2 - adMid.f2) / delta);
+      } else {
+        y = std::tanh(0.5 * (mid + lane.x1));
+      }
+    }
+
+    lane.d1 = d1;
+    lane.x2 = lane.x1;
+  }
+
+  lane.x1 = x;
+  lane.f1 = ad.f1;
+  lane.f2 = ad.f2;
+  return (float)y;
+}
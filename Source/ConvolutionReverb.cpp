@@ -0,0 +1,638 @@
+#include "ConvolutionReverb.h"
+
+namespace {
+// Generated caves: early reflections off nearby rock, then a diffuse tail that
+// loses its top end as it decays
+struct SpaceShape {
+  double seconds;
+  double rt60;
+  double preDelayMs;
+  double brightHz; // Tail cutoff at the start...
+  double darkHz;   // ...and where it settles
+  juce::int64 seed;
+};
+
+constexpr SpaceShape spaceShapes[] = {
+    {5.0, 3.5, 12.0, 9000.0, 1800.0, 0x43617665},  // Cave
+    {8.0, 5.5, 22.0, 7000.0, 1200.0, 0x44656570},  // Deep Cave
+    {10.0, 7.0, 35.0, 5500.0, 800.0, 0x41627973}}; // Abyss
+
+constexpr int numReflections = 14;
+constexpr double reflectionSpreadMs = 80.0;
+constexpr double tailFadeInMs = 30.0;
+
+juce::AudioBuffer<float> generateSpace(int space, double sampleRate) {
+  const auto &shape = spaceShapes[juce::jlimit(0, 2, space)];
+  const int length = (int)(shape.seconds * sampleRate);
+  const int onset = (int)(shape.preDelayMs * 0.001 * sampleRate);
+
+  juce::AudioBuffer<float> ir(2, length);
+  ir.clear();
+  juce::Random random(shape.seed);
+
+  const double decayPerSample = std::exp(-6.907755 / (shape.rt60 * sampleRate));
+  const double fadeInSamples = tailFadeInMs * 0.001 * sampleRate;
+  const double darkenSamples = 0.3 * shape.rt60 * sampleRate;
+  const double twoPiOverRate =
+      juce::MathConstants<double>::twoPi / sampleRate;
+
+  for (int ch = 0; ch < 2; ++ch) {
+    float *data = ir.getWritePointer(ch);
+
+    for (int r = 0; r < numReflections; ++r) {
+      const double ms = reflectionSpreadMs * random.nextFloat();
+      const int pos = onset + (int)(ms * 0.001 * sampleRate);
+      const float sign = random.nextFloat() < 0.5f ? -1.0f : 1.0f;
+      const float level = 0.5f + 0.5f * random.nextFloat();
+      if (pos < length)
+        data[pos] += sign * level * (1.0f - (float)r / numReflections);
+    }
+
+    double envelope = 0.25;
+    double lowpass = 0.0;
+    for (int i = onset; i < length; ++i) {
+      const double t = i - onset;
+      const double cutoff = shape.darkHz + (shape.brightHz - shape.darkHz) *
+                                               std::exp(-t / darkenSamples);
+      const double coeff = 1.0 - std::exp(-twoPiOverRate * cutoff);
+      lowpass += coeff * (2.0 * random.nextFloat() - 1.0 - lowpass);
+
+      const double fadeIn = juce::jmin(1.0, t / fadeInSamples);
+      data[i] += (float)(lowpass * envelope * fadeIn);
+      envelope *= decayPerSample;
+    }
+  }
+
+  return ir;
+}
+
+juce::AudioBuffer<float> readImpulseResponse(const juce::File &file,
+                                             double sampleRate,
+                                             double maxSeconds) {
+  juce::AudioFormatManager formats;
+  formats.registerBasicFormats();
+  std::unique_ptr<juce::AudioFormatReader> reader(
+      formats.createReaderFor(file));
+  if (reader == nullptr || reader->lengthInSamples <= 0 ||
+      reader->sampleRate <= 0.0)
+    return {};
+
+  const int fileLength = (int)juce::jmin(
+      reader->lengthInSamples, (juce::int64)(maxSeconds * reader->sampleRate));
+  const int numChannels = juce::jmin(2, (int)reader->numChannels);
+
+  juce::AudioBuffer<float> source(numChannels, fileLength);
+  reader->read(&source, 0, fileLength, 0, true, true);
+
+  if (reader->sampleRate == sampleRate)
+    return source;
+
+  // Leave the interpolator a few samples of lookahead at the end
+  const double ratio = reader->sampleRate / sampleRate;
+  const int length = juce::jmax(0, (int)((fileLength - 4) / ratio));
+
+  juce::AudioBuffer<float> resampled(numChannels, length);
+  for (int ch = 0; ch < numChannels; ++ch) {
+    juce::LagrangeInterpolator interpolator;
+    interpolator.process(ratio, source.getReadPointer(ch),
+                         resampled.getWritePointer(ch), length);
+  }
+  return resampled;
+}
+
+// Unit energy per channel, so the wet level doesn't depend on the IR length
+void normaliseEnergy(juce::AudioBuffer<float> &ir) {
+  double energy = 0.0;
+  for (int ch = 0; ch < ir.getNumChannels(); ++ch) {
+    const float *data = ir.getReadPointer(ch);
+    for (int i = 0; i < ir.getNumSamples(); ++i)
+      energy += (double)data[i] * data[i];
+  }
+
+  energy /= juce::jmax(1, ir.getNumChannels());
+  if (energy > 0.0)
+    ir.applyGain((float)(1.0 / std::sqrt(energy)));
+}
+} // namespace
+
+//==============================================================================
+// Uniformly partitioned overlap-save convolution of one channel. Spectra are
+// kept split into real and imaginary arrays so the multiply-accumulate over
+// the frequency-domain delay line is a plain vectorisable loop.
+class ConvolutionReverb::Convolver {
+public:
+  void prepare(const float *ir, int length, int blockSizeToUse) {
+    blockSize = blockSizeToUse;
+    numBins = blockSize + 1;
+    numParts = (juce::jmax(0, length) + blockSize - 1) / blockSize;
+    fdlPos = 0;
+
+    fft = std::make_unique<juce::dsp::FFT>(
+        juce::roundToInt(std::log2(2 * blockSize)));
+    work.assign((size_t)(4 * blockSize), 0.0f); // Real-only FFT needs 2N
+    window.assign((size_t)(2 * blockSize), 0.0f);
+    accRe.assign((size_t)numBins, 0.0f);
+    accIm.assign((size_t)numBins, 0.0f);
+    partRe.assign((size_t)(numParts * numBins), 0.0f);
+    partIm.assign((size_t)(numParts * numBins), 0.0f);
+    fdlRe.assign((size_t)(numParts * numBins), 0.0f);
+    fdlIm.assign((size_t)(numParts * numBins), 0.0f);
+
+    // Each partition zero-padded to two blocks
+    for (int p = 0; p < numParts; ++p) {
+      const int count = juce::jmin(blockSize, length - p * blockSize);
+      std::fill(work.begin(), work.end(), 0.0f);
+      std::copy(ir + p * blockSize, ir + p * blockSize + count, work.begin());
+      fft->performRealOnlyForwardTransform(work.data(), true);
+      deinterleave(partRe.data() + p * numBins, partIm.data() + p * numBins);
+    }
+  }
+
+  void reset() {
+    std::fill(window.begin(), window.end(), 0.0f);
+    std::fill(fdlRe.begin(), fdlRe.end(), 0.0f);
+    std::fill(fdlIm.begin(), fdlIm.end(), 0.0f);
+    fdlPos = 0;
+  }
+
+  // Takes one block of input and produces the matching block of output
+  void process(const float *input, float *output) {
+    if (numParts == 0) {
+      juce::FloatVectorOperations::clear(output, blockSize);
+      return;
+    }
+
+    // Slide the two-block input window along and transform it
+    juce::FloatVectorOperations::copy(window.data(), window.data() + blockSize,
+                                      blockSize);
+    juce::FloatVectorOperations::copy(window.data() + blockSize, input,
+                                      blockSize);
+    juce::FloatVectorOperations::copy(work.data(), window.data(),
+                                      2 * blockSize);
+    juce::FloatVectorOperations::clear(work.data() + 2 * blockSize,
+                                       2 * blockSize);
+    fft->performRealOnlyForwardTransform(work.data(), true);
+    deinterleave(fdlRe.data() + fdlPos * numBins,
+                 fdlIm.data() + fdlPos * numBins);
+
+    // Newest input spectrum against the first partition, and so on back
+    std::fill(accRe.begin(), accRe.end(), 0.0f);
+    std::fill(accIm.begin(), accIm.end(), 0.0f);
+    float *const ar = accRe.data();
+    float *const ai = accIm.data();
+    int slot = fdlPos;
+    for (int p = 0; p < numParts; ++p) {
+      const float *xr = fdlRe.data() + slot * numBins;
+      const float *xi = fdlIm.data() + slot * numBins;
+      const float *hr = partRe.data() + p * numBins;
+      const float *hi = partIm.data() + p * numBins;
+      for (int k = 0; k < numBins; ++k) {
+        ar[k] += xr[k] * hr[k] - xi[k] * hi[k];
+        ai[k] += xr[k] * hi[k] + xi[k] * hr[k];
+      }
+      slot = slot == 0 ? numParts - 1 : slot - 1;
+    }
+
+    for (int k = 0; k < numBins; ++k) {
+      work[(size_t)(2 * k)] = ar[k];
+      work[(size_t)(2 * k + 1)] = ai[k];
+    }
+    fft->performRealOnlyInverseTransform(work.data());
+
+    // Only the second half of the circular result is free of wrap-around
+    juce::FloatVectorOperations::copy(output, work.data() + blockSize,
+                                      blockSize);
+    fdlPos = (fdlPos + 1) % numParts;
+  }
+
+private:
+  void deinterleave(float *re, float *im) const {
+    for (int k = 0; k < numBins; ++k) {
+      re[k] = work[(size_t)(2 * k)];
+      im[k] = work[(size_t)(2 * k + 1)];
+    }
+  }
+
+  int blockSize = 0;
+  int numBins = 0;
+  int numParts = 0;
+  int fdlPos = 0;
+  std::unique_ptr<juce::dsp::FFT> fft;
+  std::vector<float> work, window, accRe, accIm;
+  std::vector<float> partRe, partIm; // IR partitions
+  std::vector<float> fdlRe, fdlIm;   // Frequency-domain delay line
+};
+
+//==============================================================================
+// Everything that depends on one IR. The head and early tier belong to the
+// audio thread, the late tier to the worker.
+struct ConvolutionReverb::Engine {
+  void prepare(const juce::AudioBuffer<float> &ir) {
+    lengthSamples = ir.getNumSamples();
+    for (int ch = 0; ch < 2; ++ch) {
+      const float *data =
+          ir.getReadPointer(juce::jmin(ch, ir.getNumChannels() - 1));
+
+      const int earlyTaps =
+          juce::jlimit(0, earlyLength - headLength, lengthSamples - headLength);
+      const int lateTaps = juce::jmax(0, lengthSamples - earlyLength);
+
+      headTaps[ch].assign(data, data + juce::jmin(headLength, lengthSamples));
+      headHistory[ch].assign((size_t)(2 * headLength - 1), 0.0f);
+      early[ch].prepare(earlyTaps > 0 ? data + headLength : nullptr, earlyTaps,
+                        headLength);
+      earlyInput[ch].assign((size_t)headLength, 0.0f);
+      earlyOutput[ch].assign((size_t)headLength, 0.0f);
+      late[ch].prepare(lateTaps > 0 ? data + earlyLength : nullptr, lateTaps,
+                       tailBlockSize);
+    }
+    silence.assign((size_t)tailBlockSize, 0.0f);
+    discard.assign((size_t)tailBlockSize, 0.0f);
+  }
+
+  void resetAudio() {
+    for (int ch = 0; ch < 2; ++ch) {
+      std::fill(headHistory[ch].begin(), headHistory[ch].end(), 0.0f);
+      std::fill(earlyOutput[ch].begin(), earlyOutput[ch].end(), 0.0f);
+      early[ch].reset();
+    }
+  }
+
+  void resetTail() {
+    for (auto &convolver : late)
+      convolver.reset();
+    lastTailBlock = -1;
+  }
+
+  int lengthSamples = 0;
+  std::array<std::vector<float>, 2> headTaps, headHistory;
+  std::array<Convolver, 2> early, late;
+  std::array<std::vector<float>, 2> earlyInput, earlyOutput;
+  std::vector<float> silence, discard; // Worker scratch for dropped blocks
+  juce::int64 lastTailBlock = -1;      // Worker only
+};
+
+//==============================================================================
+class ConvolutionReverb::Worker : public juce::Thread {
+public:
+  explicit Worker(ConvolutionReverb &reverbToServe)
+      : juce::Thread("Convolution Reverb"), owner(reverbToServe) {}
+
+  void run() override {
+    // Signalled (without a lock) for each tail block, retired engine and
+    // request, so it sleeps while there is no tail to compute
+    for (;;) {
+      owner.workerWakeUp.wait();
+      if (threadShouldExit())
+        break;
+
+      owner.processTailBlocks();
+      owner.collectRetiredEngine();
+      owner.serviceRequests();
+    }
+  }
+
+private:
+  ConvolutionReverb &owner;
+};
+
+//==============================================================================
+ConvolutionReverb::ConvolutionReverb() = default;
+
+ConvolutionReverb::~ConvolutionReverb() {
+  stopWorker();
+
+  delete engine;
+  delete pendingEngine.exchange(nullptr);
+  delete retiredEngine.exchange(nullptr);
+}
+
+void ConvolutionReverb::prepare(const juce::dsp::ProcessSpec &spec) {
+  stopWorker();
+
+  sampleRate = spec.sampleRate;
+  mixParam.reset(sampleRate, 0.05);
+
+  // Nothing is in flight with the worker stopped, so start from scratch
+  delete pendingEngine.exchange(nullptr);
+  delete retiredEngine.exchange(nullptr);
+  delete engine;
+  engine = nullptr;
+
+  for (auto &slot : slots) {
+    for (int ch = 0; ch < 2; ++ch) {
+      slot.input[ch].assign((size_t)tailBlockSize, 0.0f);
+      slot.output[ch].assign((size_t)tailBlockSize, 0.0f);
+    }
+    slot.engine = nullptr;
+    slot.submitted = -1;
+    slot.done = -1;
+  }
+  for (auto &channel : tailInput)
+    channel.assign((size_t)tailBlockSize, 0.0f);
+  tailBlockIndex = 0;
+
+  builtSpace = requestedSpace.load();
+  auto built = buildEngine(builtSpace, loadedFile);
+  if (built == nullptr && loadedFile != juce::File()) {
+    loadedFile = juce::File(); // The file has gone; fall back to the space
+    built = buildEngine(builtSpace, loadedFile);
+  }
+  engine = built.release();
+  irSeconds = engine->lengthSamples / sampleRate;
+
+  clearAudioState();
+  startWorker();
+}
+
+void ConvolutionReverb::startWorker() {
+  if (worker == nullptr)
+    worker = std::make_unique<Worker>(*this);
+  worker->startThread(juce::Thread::Priority::high);
+  workerWakeUp.signal(); // Pick up anything requested while it was stopped
+}
+
+void ConvolutionReverb::stopWorker() {
+  if (worker == nullptr)
+    return;
+
+  worker->signalThreadShouldExit();
+  workerWakeUp.signal();
+  worker->stopThread(4000);
+}
+
+void ConvolutionReverb::reset() { clearAudioState(); }
+
+void ConvolutionReverb::clearAudioState() {
+  if (engine != nullptr)
+    engine->resetAudio();
+  for (auto &channel : tailInput)
+    std::fill(channel.begin(), channel.end(), 0.0f);
+
+  // Restart the tail block; output from before now is stale and the worker
+  // clears its delay line with the next block it gets
+  headPos = 0;
+  tailPos = 0;
+  playingSlot = nullptr;
+  firstValidBlock = tailBlockIndex;
+  tailResetPending = true;
+  idle = true;
+  quietSamples = 0;
+}
+
+void ConvolutionReverb::loadImpulseResponse(const juce::File &file) {
+  {
+    const juce::ScopedLock sl(fileLock);
+    requestedFile = file;
+    fileRequested = true;
+  }
+  workerWakeUp.signal();
+}
+
+void ConvolutionReverb::setSpace(Space newSpace) {
+  if (requestedSpace.exchange((int)newSpace) != (int)newSpace)
+    workerWakeUp.signal();
+}
+
+//==============================================================================
+void ConvolutionReverb::serviceRequests() {
+  juce::File file;
+  bool haveFile = false;
+  {
+    const juce::ScopedLock sl(fileLock);
+    std::swap(haveFile, fileRequested);
+    file = requestedFile;
+  }
+
+  const int space = requestedSpace.load();
+  if (!haveFile && space == builtSpace)
+    return;
+
+  builtSpace = space;
+  if (!haveFile)
+    file = juce::File();
+
+  if (auto built = buildEngine(space, file)) {
+    loadedFile = file;
+    // Replace anything the audio thread hasn't picked up yet
+    delete pendingEngine.exchange(built.release(), std::memory_order_acq_rel);
+  }
+}
+
+std::unique_ptr<ConvolutionReverb::Engine>
+ConvolutionReverb::buildEngine(int space, const juce::File &file) const {
+  auto ir = file.existsAsFile()
+                ? readImpulseResponse(file, sampleRate, maxIrSeconds)
+                : generateSpace(space, sampleRate);
+  if (ir.getNumChannels() == 0 || ir.getNumSamples() == 0)
+    return nullptr;
+
+  normaliseEnergy(ir);
+  auto built = std::make_unique<Engine>();
+  built->prepare(ir);
+  return built;
+}
+
+void ConvolutionReverb::processTailBlocks() {
+  for (;;) {
+    // Oldest outstanding block first
+    TailSlot *next = nullptr;
+    juce::int64 nextIndex = std::numeric_limits<juce::int64>::max();
+    for (auto &slot : slots) {
+      const auto submitted = slot.submitted.load(std::memory_order_acquire);
+      if (submitted > slot.done.load(std::memory_order_relaxed) &&
+          submitted < nextIndex) {
+        next = &slot;
+        nextIndex = submitted;
+      }
+    }
+
+    if (next == nullptr)
+      return;
+    runTailBlock(*next, nextIndex);
+  }
+}
+
+void ConvolutionReverb::runTailBlock(TailSlot &slot, juce::int64 index) {
+  auto &e = *slot.engine;
+  if (slot.resetFirst)
+    e.resetTail();
+
+  // Blocks the audio thread had to drop go in as silence, so later
+  // partitions stay lined up with their input
+  if (e.lastTailBlock >= 0) {
+    for (auto gap = juce::jmin(index - e.lastTailBlock - 1, (juce::int64)64);
+         gap > 0; --gap)
+      for (auto &convolver : e.late)
+        convolver.process(e.silence.data(), e.discard.data());
+  }
+  e.lastTailBlock = index;
+
+  for (int ch = 0; ch < 2; ++ch)
+    e.late[ch].process(slot.input[ch].data(), slot.output[ch].data());
+
+  slot.done.store(index, std::memory_order_release);
+}
+
+void ConvolutionReverb::collectRetiredEngine() {
+  auto *retired = retiredEngine.load(std::memory_order_acquire);
+  if (retired == nullptr)
+    return;
+
+  // Blocks submitted before the swap may still point at it
+  processTailBlocks();
+  delete retired;
+  retiredEngine.store(nullptr, std::memory_order_release);
+}
+
+//==============================================================================
+void ConvolutionReverb::adoptPendingEngine() {
+  // One swap at a time: wait until the worker has freed the last one
+  if (pendingEngine.load(std::memory_order_relaxed) == nullptr ||
+      retiredEngine.load(std::memory_order_acquire) != nullptr)
+    return;
+
+  auto *next = pendingEngine.exchange(nullptr, std::memory_order_acq_rel);
+  if (next == nullptr)
+    return;
+
+  retiredEngine.store(engine, std::memory_order_release);
+  workerWakeUp.signal();
+  engine = next;
+  irSeconds = engine->lengthSamples / sampleRate;
+  clearAudioState();
+}
+
+bool ConvolutionReverb::process(juce::AudioBuffer<float> &buffer,
+                                bool inputSilent) {
+  adoptPendingEngine();
+
+  const int numSamples = buffer.getNumSamples();
+  const int numChannels = juce::jmin(2, buffer.getNumChannels());
+  if (engine == nullptr || numChannels == 0)
+    return false;
+
+  // Switched off: drop the tail so it doesn't come back with the mix
+  if (!mixParam.isSmoothing() && mixParam.getTargetValue() <= 0.0f) {
+    if (!idle)
+      clearAudioState();
+    return false;
+  }
+
+  if (inputSilent) {
+    if (!idle) {
+      quietSamples += numSamples;
+      if (quietSamples > engine->lengthSamples + 2 * tailBlockSize)
+        clearAudioState();
+    }
+    if (idle) {
+      mixParam.skip(numSamples);
+      return false;
+    }
+  } else {
+    quietSamples = 0;
+    idle = false;
+  }
+
+  float *channels[2] = {};
+  for (int ch = 0; ch < numChannels; ++ch)
+    channels[ch] = buffer.getWritePointer(ch);
+
+  // Runs never cross a head block boundary (and so never a tail one)
+  for (int pos = 0; pos < numSamples;) {
+    const int runLength = juce::jmin(numSamples - pos, headLength - headPos);
+    float *run[2] = {channels[0] + pos,
+                     numChannels > 1 ? channels[1] + pos : nullptr};
+    renderRun(run, numChannels, runLength);
+    pos += runLength;
+
+    headPos += runLength;
+    if (headPos == headLength) {
+      for (int ch = 0; ch < numChannels; ++ch)
+        engine->early[ch].process(engine->earlyInput[ch].data(),
+                                  engine->earlyOutput[ch].data());
+      headPos = 0;
+    }
+
+    tailPos += runLength;
+    if (tailPos == tailBlockSize)
+      finishTailBlock();
+  }
+
+  return true;
+}
+
+void ConvolutionReverb::renderRun(float *const *channels, int numChannels,
+                                  int numSamples) {
+  const bool ramping = mixRamp.generate(mixParam, numSamples);
+  const float mix = mixRamp.getValue();
+
+  float *wet = wetScratch.data();
+  for (int ch = 0; ch < numChannels; ++ch) {
+    float *x = channels[ch];
+
+    // Direct FIR head over the previous headLength - 1 inputs and this run
+    const auto &taps = engine->headTaps[ch];
+    float *line = engine->headHistory[ch].data();
+    juce::FloatVectorOperations::copy(line + headLength - 1, x, numSamples);
+    juce::FloatVectorOperations::clear(wet, numSamples);
+    for (size_t k = 0; k < taps.size(); ++k)
+      juce::FloatVectorOperations::addWithMultiply(
+          wet, line + headLength - 1 - k, taps[k], numSamples);
+    std::memmove(line, line + numSamples,
+                 (size_t)(headLength - 1) * sizeof(float));
+
+    // Early and late tiers, computed a block ago
+    juce::FloatVectorOperations::add(
+        wet, engine->earlyOutput[ch].data() + headPos, numSamples);
+    juce::FloatVectorOperations::copy(engine->earlyInput[ch].data() + headPos,
+                                      x, numSamples);
+    if (playingSlot != nullptr)
+      juce::FloatVectorOperations::add(
+          wet, playingSlot->output[ch].data() + tailPos, numSamples);
+    juce::FloatVectorOperations::copy(tailInput[ch].data() + tailPos, x,
+                                      numSamples);
+
+    // x + (wet - x) * mix
+    juce::FloatVectorOperations::subtract(wet, x, numSamples);
+    if (ramping)
+      juce::FloatVectorOperations::multiply(wet, mixRamp.getRamp(numSamples),
+                                            numSamples);
+    else
+      juce::FloatVectorOperations::multiply(wet, mix, numSamples);
+    juce::FloatVectorOperations::add(x, wet, numSamples);
+  }
+}
+
+void ConvolutionReverb::finishTailBlock() {
+  const auto index = tailBlockIndex++;
+  tailPos = 0;
+
+  // Hand the block over unless the worker is still on this slot's previous
+  // block, in which case it's dropped (and shows up as a miss below)
+  auto &slot = slots[(size_t)(index % numTailSlots)];
+  if (slot.submitted.load(std::memory_order_relaxed) ==
+      slot.done.load(std::memory_order_acquire)) {
+    for (int ch = 0; ch < 2; ++ch)
+      std::copy(tailInput[ch].begin(), tailInput[ch].end(),
+                slot.input[ch].begin());
+    slot.engine = engine;
+    slot.resetFirst = std::exchange(tailResetPending, false);
+    slot.submitted.store(index, std::memory_order_release);
+    workerWakeUp.signal();
+  }
+
+  // The previous block's output plays over the next one
+  playingSlot = nullptr;
+  const auto ready = index - 1;
+  if (ready < firstValidBlock)
+    return;
+
+  auto &out = slots[(size_t)(ready % numTailSlots)];
+  if (out.engine != engine)
+    return;
+  if (out.done.load(std::memory_order_acquire) == ready)
+    playingSlot = &out;
+  else
+    ++missedDeadlines;
+}
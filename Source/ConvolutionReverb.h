@@ -0,0 +1,136 @@
+#pragma once
+#include "LightweightSemaphore.h"
+#include "ParameterRamp.h"
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Zero-latency convolution reverb with a non-uniformly partitioned IR.
+
+    - Taps [0, 128) run as a direct FIR on the audio thread.
+    - Taps [128, 8192) run as uniformly partitioned FFT convolution in
+      128-sample blocks on the audio thread. The one-block FFT latency is
+      hidden behind the FIR head.
+    - The rest of the IR runs in 4096-sample partitions on a background
+      thread. A block handed over at time t isn't heard until t + 4096, so
+      the worker has a whole block period to deliver; a late block is
+      dropped (and counted) rather than waited for. The worker sleeps until
+      it's handed something, so with the mix at zero or the reverb idle it
+      costs nothing.
+
+    Impulse responses, either the built-in generated caves or a file, are
+    decoded, resampled and transformed on the background thread and swapped
+    in at the start of an audio block without locking.
+*/
+class ConvolutionReverb {
+public:
+  // Built-in, procedurally generated spaces
+  enum class Space { Cave, DeepCave, Abyss };
+
+  static constexpr int headLength = 128;   // Direct FIR taps
+  static constexpr int earlyLength = 8192; // End of the audio-thread tier
+  static constexpr int tailBlockSize = 4096;
+  static constexpr double maxIrSeconds = 10.0;
+
+  ConvolutionReverb();
+  ~ConvolutionReverb();
+
+  // Builds the current IR for the new rate and (re)starts the background
+  // thread. Not real-time safe.
+  void prepare(const juce::dsp::ProcessSpec &spec);
+  void reset();
+
+  void setMix(float mix01) { mixParam.setTargetValue(mix01); }
+
+  // Switches to a built-in space; the new IR is built in the background
+  void setSpace(Space newSpace);
+
+  // Loads an IR from a file in the background, replacing the built-in space
+  // until the space is changed again
+  void loadImpulseResponse(const juce::File &file);
+
+  // Mixes the convolved signal into the buffer. Returns true if it may have
+  // written anything (false while asleep on silent input or with the mix at
+  // zero).
+  bool process(juce::AudioBuffer<float> &buffer, bool inputSilent);
+
+  // Moves the mix smoother on as if a silent block had been processed
+  void skip(int numSamples) { mixParam.skip(numSamples); }
+
+  bool isIdle() const { return idle; }
+
+  // Length of the loaded IR
+  double getTailLengthSeconds() const { return irSeconds.load(); }
+
+  // Tail blocks the background thread couldn't deliver in time
+  int getMissedDeadlines() const { return missedDeadlines.load(); }
+
+private:
+  class Convolver;
+  struct Engine;
+  class Worker;
+
+  static constexpr int numTailSlots = 4;
+
+  // One handed-over block of tail input and the tail output it produces.
+  // The audio thread owns a slot while submitted == done, the worker while
+  // submitted > done.
+  struct TailSlot {
+    std::array<std::vector<float>, 2> input, output;
+    Engine *engine = nullptr;
+    bool resetFirst = false;
+    std::atomic<juce::int64> submitted{-1};
+    std::atomic<juce::int64> done{-1};
+  };
+
+  // Background thread
+  void startWorker();
+  void stopWorker();
+  void serviceRequests();
+  std::unique_ptr<Engine> buildEngine(int space, const juce::File &file) const;
+  void processTailBlocks();
+  void runTailBlock(TailSlot &slot, juce::int64 index);
+  void collectRetiredEngine();
+
+  // Audio thread
+  void adoptPendingEngine();
+  void renderRun(float *const *channels, int numChannels, int numSamples);
+  void finishTailBlock();
+  void clearAudioState();
+
+  double sampleRate = 44100.0;
+  std::unique_ptr<Worker> worker;
+  LightweightSemaphore workerWakeUp; // One signal per thing to do
+
+  // The worker publishes new engines through pendingEngine; the audio thread
+  // swaps one in and hands the old one back through retiredEngine
+  Engine *engine = nullptr;
+  std::atomic<Engine *> pendingEngine{nullptr};
+  std::atomic<Engine *> retiredEngine{nullptr};
+
+  std::atomic<int> requestedSpace{(int)Space::Cave};
+  int builtSpace = -1;     // Worker (or prepare, with the worker stopped)
+  juce::File loadedFile;   // Ditto; empty for a built-in space
+  juce::CriticalSection fileLock;
+  juce::File requestedFile; // Guarded by fileLock
+  bool fileRequested = false;
+
+  std::array<TailSlot, numTailSlots> slots;
+  std::array<std::vector<float>, 2> tailInput;
+  juce::int64 tailBlockIndex = 0; // Tail input block being filled
+  juce::int64 firstValidBlock = 0; // Older tail output predates a reset
+  int headPos = 0;                // Position in the current 128-sample block
+  int tailPos = 0;                // Position in the current tail block
+  TailSlot *playingSlot = nullptr;
+  bool tailResetPending = false;
+
+  std::array<float, headLength> wetScratch{};
+  juce::LinearSmoothedValue<float> mixParam;
+  ParameterRamp mixRamp; // Runs are never longer than headLength
+  bool idle = true;
+  juce::int64 quietSamples = 0;
+  std::atomic<double> irSeconds{0.0};
+  std::atomic<int> missedDeadlines{0};
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ConvolutionReverb)
+};
@@ -52,6 +52,20 @@ void PadButton::setFlashing(bool isFlashing) {
   repaint();
 }
 
+void PadButton::mouseDown(const juce::MouseEvent &e) {
+  if (e.mods.isPopupMenu()) {
+    if (onMenuRequested)
+      onMenuRequested();
+    return;
+  }
+  juce::Button::mouseDown(e);
+}
+
+void PadButton::mouseUp(const juce::MouseEvent &e) {
+  if (!e.mods.isPopupMenu())
+    juce::Button::mouseUp(e);
+}
+
 //==============================================================================
 // DrumTab Implementation
 //==============================================================================
@@ -95,6 +109,7 @@ DrumTab::DrumTab(SampleManager &sm, SynthEngine &se)
   for (int i = 0; i < 16; ++i) {
     auto *pad = new PadButton(startNote + i, "Pad " + juce::String(i + 1));
     pad->addListener(this);
+    pad->onMenuRequested = [this, i] { showPadMenu(i); };
     pads.add(pad);
     addAndMakeVisible(pad);
   }
@@ -198,6 +213,43 @@ void DrumTab::loadKit(const juce::File &dir) {
   }
 }
 
+void DrumTab::showPadMenu(int padIndex) {
+  const auto voicing = sampleManager.getPadVoicing(padIndex);
+
+  // Runs after the menu closes; the SampleManager outlives this tab
+  auto *manager = &sampleManager;
+  auto setVoicing = [manager, padIndex](int chokeGroup, int maxVoices) {
+    manager->setPadVoicing(padIndex, {chokeGroup, maxVoices});
+  };
+
+  juce::PopupMenu chokeMenu;
+  chokeMenu.addItem("Auto (hi-hats)", true,
+                    voicing.chokeGroup == SampleManager::autoChokeGroup,
+                    [=] {
+                      setVoicing(SampleManager::autoChokeGroup,
+                                 voicing.maxVoices);
+                    });
+  chokeMenu.addItem("None", true, voicing.chokeGroup == 0,
+                    [=] { setVoicing(0, voicing.maxVoices); });
+  for (int group = 1; group <= 4; ++group)
+    chokeMenu.addItem("Group " + juce::String(group), true,
+                      voicing.chokeGroup == group,
+                      [=] { setVoicing(group, voicing.maxVoices); });
+
+  juce::PopupMenu voicesMenu;
+  for (int limit : {1, 2, 4, 8, 0})
+    voicesMenu.addItem(limit == 0 ? "Unlimited" : juce::String(limit), true,
+                       voicing.maxVoices == limit,
+                       [=] { setVoicing(voicing.chokeGroup, limit); });
+
+  juce::PopupMenu menu;
+  menu.addSectionHeading("Pad " + juce::String(padIndex + 1));
+  menu.addSubMenu("Choke Group", chokeMenu);
+  menu.addSubMenu("Max Voices", voicesMenu);
+  menu.showMenuAsync(
+      juce::PopupMenu::Options().withTargetComponent(pads[padIndex]));
+}
+
 void DrumTab::browseUserKit() {
   fileChooser = std::make_unique<juce::FileChooser>(
       "Select Drum Kit Folder",
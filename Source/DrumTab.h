@@ -17,6 +17,12 @@ public:
   int getNoteNumber() const { return noteNumber; }
   void setFlashing(bool isFlashing); // For visual feedback
 
+  // Right-click (instead of playing the pad)
+  std::function<void()> onMenuRequested;
+
+  void mouseDown(const juce::MouseEvent &e) override;
+  void mouseUp(const juce::MouseEvent &e) override;
+
 private:
   int noteNumber;
   bool flashing = false;
@@ -45,6 +51,7 @@ private:
   void scanForKits();
   void loadKit(const juce::File &dir);
   void browseUserKit();
+  void showPadMenu(int padIndex);
 
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DrumTab)
 };
@@ -0,0 +1,107 @@
+#include "EffectGraph.h"
+
+EffectGraph EffectGraph::fromPreset(Preset preset) {
+  using N = Node;
+  EffectGraph graph;
+
+  // The bitcrusher always follows the distortion it used to be part of
+  switch (preset) {
+  default:
+  case Preset::Standard: // Dist -> Bite -> Delay -> Reverb
+    graph.then(N::Distortion).then(N::Bitcrusher).then(N::TransientShaper);
+    graph.then(N::Delay).then(N::Reverb);
+    break;
+  case Preset::Ethereal: // Reverb -> Delay -> Dist -> Bite
+    graph.then(N::Reverb).then(N::Delay);
+    graph.then(N::Distortion).then(N::Bitcrusher).then(N::TransientShaper);
+    break;
+  case Preset::Chaos: // Delay -> Dist -> Bite -> Reverb
+    graph.then(N::Delay);
+    graph.then(N::Distortion).then(N::Bitcrusher).then(N::TransientShaper);
+    graph.then(N::Reverb);
+    break;
+  case Preset::Reverse: // Reverb -> Delay -> Bite -> Dist
+    graph.then(N::Reverb).then(N::Delay);
+    graph.then(N::TransientShaper).then(N::Distortion).then(N::Bitcrusher);
+    break;
+  case Preset::ParallelSends: // Dist -> Bite -> (Delay + Reverb)
+    graph.then(N::Distortion).then(N::Bitcrusher).then(N::TransientShaper);
+    graph.split(makeBranch({N::Delay}), makeBranch({N::Reverb}));
+    break;
+  }
+  return graph;
+}
+
+EffectGraph::Branch EffectGraph::makeBranch(std::initializer_list<Node> nodes) {
+  Branch branch;
+  for (auto node : nodes)
+    if (branch.numNodes < numNodeTypes)
+      branch.nodes[(size_t)branch.numNodes++] = node;
+  return branch;
+}
+
+bool EffectGraph::addToBranch(Branch &branch, Node node) {
+  // Every node is a single processor with its own state
+  jassert(!used[index(node)]);
+  if (used[index(node)] || branch.numNodes >= numNodeTypes)
+    return false;
+
+  used[index(node)] = true;
+  branch.nodes[(size_t)branch.numNodes++] = node;
+  return true;
+}
+
+EffectGraph &EffectGraph::then(Node node) {
+  if (numStages >= maxStages)
+    return *this;
+
+  Stage stage;
+  stage.numBranches = 1;
+  if (addToBranch(stage.branches[0], node))
+    stages[(size_t)numStages++] = stage;
+  return *this;
+}
+
+EffectGraph &EffectGraph::split(const Branch &first, const Branch &second) {
+  if (numStages >= maxStages)
+    return *this;
+
+  Stage stage;
+  for (const auto *source : {&first, &second}) {
+    auto &branch = stage.branches[(size_t)stage.numBranches];
+    for (int n = 0; n < source->numNodes; ++n)
+      addToBranch(branch, source->nodes[(size_t)n]);
+    if (branch.numNodes > 0)
+      ++stage.numBranches;
+  }
+
+  if (stage.numBranches > 0)
+    stages[(size_t)numStages++] = stage;
+  return *this;
+}
+
+bool EffectGraph::hasSameLayout(const EffectGraph &other) const {
+  if (numStages != other.numStages || used != other.used)
+    return false;
+
+  for (int s = 0; s < numStages; ++s) {
+    const auto &a = stages[(size_t)s];
+    const auto &b = other.stages[(size_t)s];
+    if (a.numBranches != b.numBranches)
+      return false;
+
+    for (int br = 0; br < a.numBranches; ++br) {
+      const auto &x = a.branches[(size_t)br];
+      const auto &y = b.branches[(size_t)br];
+      if (x.numNodes != y.numNodes ||
+          !std::equal(x.nodes.begin(), x.nodes.begin() + x.numNodes,
+                      y.nodes.begin()))
+        return false;
+    }
+  }
+  return true;
+}
+
+bool EffectGraph::operator==(const EffectGraph &other) const {
+  return bypassed == other.bypassed && hasSameLayout(other);
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Layout of the effects section: a list of stages run one after another.
+
+    A stage is either a single branch (plain serial processing) or a split
+    into parallel branches. Every branch sees the stage input, and the stage
+    output is the input plus each branch's change to it. With a delay and a
+    reverb branch this gives the classic parallel sends: dry + delay wet +
+    reverb wet, each send level being that effect's own mix.
+
+    Each effect node can appear once and has its own bypass. The graph is a
+    fixed-size value type, so it can be built on the message thread and
+    copied across to the audio thread without allocating.
+*/
+class EffectGraph {
+public:
+  enum class Node { Distortion, Bitcrusher, TransientShaper, Delay, Reverb };
+  static constexpr int numNodeTypes = 5;
+  static constexpr int maxBranches = 2;
+  static constexpr int maxStages = numNodeTypes;
+
+  // The chain presets behind the Signal Chain parameter
+  enum class Preset { Standard, Ethereal, Chaos, Reverse, ParallelSends };
+
+  struct Branch {
+    std::array<Node, numNodeTypes> nodes{};
+    int numNodes = 0;
+  };
+
+  struct Stage {
+    std::array<Branch, maxBranches> branches{};
+    int numBranches = 0;
+
+    // A lone branch runs in place on the buffer
+    bool isSerial() const { return numBranches == 1; }
+  };
+
+  EffectGraph() = default;
+
+  static EffectGraph fromPreset(Preset preset);
+  static Branch makeBranch(std::initializer_list<Node> nodes);
+
+  // Appends a serial stage holding one node
+  EffectGraph &then(Node node);
+
+  // Appends a stage that splits into the given branches
+  EffectGraph &split(const Branch &first, const Branch &second);
+
+  void setBypassed(Node node, bool shouldBypass) {
+    bypassed[index(node)] = shouldBypass;
+  }
+  bool isBypassed(Node node) const { return bypassed[index(node)]; }
+
+  // In the graph and not bypassed
+  bool isActive(Node node) const {
+    return used[index(node)] && !bypassed[index(node)];
+  }
+
+  int getNumStages() const { return numStages; }
+  const Stage &getStage(int stage) const { return stages[(size_t)stage]; }
+
+  // Same stages holding the same nodes, whatever is bypassed
+  bool hasSameLayout(const EffectGraph &other) const;
+
+  bool operator==(const EffectGraph &other) const;
+  bool operator!=(const EffectGraph &other) const { return !(*this == other); }
+
+private:
+  static size_t index(Node node) { return (size_t)node; }
+  bool addToBranch(Branch &branch, Node node);
+
+  std::array<Stage, maxStages> stages{};
+  int numStages = 0;
+  std::array<bool, numNodeTypes> used{};
+  std::array<bool, numNodeTypes> bypassed{};
+};
@@ -0,0 +1,162 @@
+#include "EffectsOversampler.h"
+
+namespace {
+// Slack on top of the filters' span when deciding they have settled
+constexpr int settleMargin = 32;
+} // namespace
+
+void EffectsOversampler::prepare(const juce::dsp::ProcessSpec &spec) {
+  maxBlockSize = (int)spec.maximumBlockSize;
+  const auto numChannels =
+      (size_t)juce::jlimit(1, maxChannels, (int)spec.numChannels);
+
+  // Linear-phase half-band stages, padded to a whole-sample latency so the
+  // bypass delay and the host compensation line up exactly
+  latencies[0] = 0;
+  int maxLatency = 0;
+  for (size_t i = 1; i < (size_t)numFactors; ++i) {
+    stages[i] = std::make_unique<Oversampling>(
+        numChannels, i, Oversampling::filterHalfBandFIREquiripple, true, true);
+    stages[i]->initProcessing(spec.maximumBlockSize);
+    latencies[i] = juce::roundToInt(stages[i]->getLatencyInSamples());
+    maxLatency = juce::jmax(maxLatency, latencies[i]);
+  }
+
+  // Room for the warm-up span behind the newest block
+  const int capacity =
+      juce::nextPowerOfTwo(2 * maxLatency + settleMargin + maxBlockSize);
+  history.setSize(maxChannels, capacity);
+  historyMask = capacity - 1;
+  primeBuffer.setSize(maxChannels, maxBlockSize);
+
+  reset();
+}
+
+void EffectsOversampler::reset() {
+  for (auto &stage : stages)
+    if (stage != nullptr)
+      stage->reset();
+
+  history.clear();
+  writePos = 0;
+  running = false;
+  quietSamples = getSettleSamples();
+}
+
+bool EffectsOversampler::setFactorIndex(int index) {
+  index = juce::jlimit(0, numFactors - 1, index);
+  if (index == factorIndex)
+    return false;
+
+  factorIndex = index;
+  running = false; // The new cascade warms up from the history
+  quietSamples = juce::jmin(quietSamples, getSettleSamples());
+  return true;
+}
+
+int EffectsOversampler::getSettleSamples() const {
+  const int latency = getLatencySamples();
+  return latency > 0 ? 2 * latency + settleMargin : 0;
+}
+
+void EffectsOversampler::noteInput(bool silent, int numSamples) {
+  if (silent)
+    quietSamples = juce::jmin(quietSamples + numSamples, getSettleSamples());
+  else
+    quietSamples = 0;
+}
+
+bool EffectsOversampler::isIdle() const {
+  return quietSamples >= getSettleSamples();
+}
+
+void EffectsOversampler::writeHistory(const juce::AudioBuffer<float> &buffer,
+                                      int numChannels) {
+  const int numSamples = buffer.getNumSamples();
+  const int capacity = history.getNumSamples();
+  const int first = juce::jmin(numSamples, capacity - writePos);
+
+  for (int ch = 0; ch < numChannels; ++ch) {
+    const float *src = buffer.getReadPointer(ch);
+    float *dst = history.getWritePointer(ch);
+    std::copy(src, src + first, dst + writePos);
+    std::copy(src + first, src + numSamples, dst);
+  }
+  writePos = (writePos + numSamples) & historyMask;
+}
+
+void EffectsOversampler::prime(int numChannels) {
+  // Run the input that led up to this block through the fresh cascades,
+  // discarding the output, so they pick up exactly where the bypass delay
+  // left off
+  auto &stage = *stages[(size_t)factorIndex];
+  stage.reset();
+
+  int remaining = getSettleSamples();
+  int readPos = (writePos - remaining) & historyMask;
+  while (remaining > 0) {
+    const int chunk = juce::jmin(remaining, maxBlockSize);
+    for (int ch = 0; ch < numChannels; ++ch) {
+      const float *src = history.getReadPointer(ch);
+      float *dst = primeBuffer.getWritePointer(ch);
+      for (int i = 0; i < chunk; ++i)
+        dst[i] = src[(readPos + i) & historyMask];
+    }
+
+    juce::dsp::AudioBlock<float> block(primeBuffer.getArrayOfWritePointers(),
+                                       (size_t)numChannels, (size_t)chunk);
+    stage.processSamplesUp(juce::dsp::AudioBlock<const float>(
+        primeBuffer.getArrayOfReadPointers(), (size_t)numChannels,
+        (size_t)chunk));
+    stage.processSamplesDown(block);
+
+    readPos = (readPos + chunk) & historyMask;
+    remaining -= chunk;
+  }
+}
+
+juce::AudioBuffer<float>
+EffectsOversampler::processUp(juce::AudioBuffer<float> &buffer) {
+  const int numChannels = juce::jmin(buffer.getNumChannels(), maxChannels);
+  if (!running) {
+    prime(numChannels);
+    running = true;
+  }
+  writeHistory(buffer, numChannels);
+
+  juce::dsp::AudioBlock<const float> block(buffer.getArrayOfReadPointers(),
+                                           (size_t)numChannels,
+                                           (size_t)buffer.getNumSamples());
+  auto upsampled = stages[(size_t)factorIndex]->processSamplesUp(block);
+
+  float *channels[maxChannels] = {};
+  for (int ch = 0; ch < numChannels; ++ch)
+    channels[ch] = upsampled.getChannelPointer((size_t)ch);
+  return juce::AudioBuffer<float>(channels, numChannels,
+                                  (int)upsampled.getNumSamples());
+}
+
+void EffectsOversampler::processDown(juce::AudioBuffer<float> &buffer) {
+  juce::dsp::AudioBlock<float> block(
+      buffer.getArrayOfWritePointers(),
+      (size_t)juce::jmin(buffer.getNumChannels(), maxChannels),
+      (size_t)buffer.getNumSamples());
+  stages[(size_t)factorIndex]->processSamplesDown(block);
+}
+
+void EffectsOversampler::bypass(juce::AudioBuffer<float> &buffer) {
+  const int numChannels = juce::jmin(buffer.getNumChannels(), maxChannels);
+  const int numSamples = buffer.getNumSamples();
+  running = false;
+  writeHistory(buffer, numChannels);
+
+  // The block now ends at writePos; read it back latency samples earlier
+  const int readPos =
+      (writePos - numSamples - getLatencySamples()) & historyMask;
+  for (int ch = 0; ch < numChannels; ++ch) {
+    const float *src = history.getReadPointer(ch);
+    float *dst = buffer.getWritePointer(ch);
+    for (int i = 0; i < numSamples; ++i)
+      dst[i] = src[(readPos + i) & historyMask];
+  }
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Shared 1x/2x/4x/8x oversampling around the nonlinear effect stages.
+
+    The stages are run back to back on one upsampled buffer, so a single pair
+    of half-band polyphase cascades serves all of them. The filters are linear
+    phase and padded to a whole-sample latency, which the processor reports to
+    the host.
+
+    When none of the stages is doing anything the cascades are skipped and the
+    block goes through a plain delay of the same length instead, so the
+    reported latency never changes with activity. The delay line doubles as the
+    input history used to warm the filters back up when the stages wake.
+*/
+class EffectsOversampler {
+public:
+  static constexpr int numFactors = 4; // 1x, 2x, 4x, 8x
+  static constexpr int maxChannels = 2;
+
+  EffectsOversampler() = default;
+
+  // Builds every factor's cascade up front so switching never allocates
+  void prepare(const juce::dsp::ProcessSpec &spec);
+  void reset();
+
+  // 0 = 1x, 1 = 2x, 2 = 4x, 3 = 8x. Returns true if the factor changed.
+  bool setFactorIndex(int index);
+  int getFactor() const { return 1 << factorIndex; }
+
+  // Whole samples of delay at the current factor (0 at 1x)
+  int getLatencySamples() const { return latencies[(size_t)factorIndex]; }
+  int getMaxLatencySamples() const {
+    return *std::max_element(latencies.begin(), latencies.end());
+  }
+
+  // Upsamples the block and returns a view of the oversampled audio, which
+  // stays valid until processDown()
+  juce::AudioBuffer<float> processUp(juce::AudioBuffer<float> &buffer);
+  void processDown(juce::AudioBuffer<float> &buffer);
+
+  // Delays the block by the latency without running the cascades
+  void bypass(juce::AudioBuffer<float> &buffer);
+
+  // Notes whether the block about to be processed is silent. Call once per
+  // block before processUp() or bypass().
+  void noteInput(bool silent, int numSamples);
+
+  // True once enough silence has gone in that nothing is left in flight
+  bool isIdle() const;
+
+  // Skips a silent block entirely. Only valid while idle: the newest history
+  // is already silence, so nothing needs writing.
+  void skipSilence(int numSamples) { noteInput(true, numSamples); }
+
+private:
+  int getSettleSamples() const;
+  void writeHistory(const juce::AudioBuffer<float> &buffer, int numChannels);
+  void prime(int numChannels);
+
+  using Oversampling = juce::dsp::Oversampling<float>;
+  std::array<std::unique_ptr<Oversampling>, numFactors> stages;
+  std::array<int, numFactors> latencies{};
+  int factorIndex = 0;
+  int maxBlockSize = 0;
+
+  bool running = false;  // Cascades hold the recent input
+  int quietSamples = 0;  // Silent input since the last sound
+
+  // Input history: the bypass delay line and the warm-up source
+  juce::AudioBuffer<float> history;
+  int historyMask = 0;
+  int writePos = 0;
+
+  juce::AudioBuffer<float> primeBuffer; // Warm-up output, discarded
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EffectsOversampler)
+};
@@ -1,82 +1,103 @@
 #include "EffectsProcessor.h"
 
 EffectsProcessor::EffectsProcessor() {
-  // Initialize Waveshaper with tanh transfer function
-  distortion.functionToUse = [](float x) { return std::tanh(x); };
-
-  // Delay setup
-  delayLine.setMaximumDelayInSamples(44100 * 2);
+  graph = EffectGraph::fromPreset(EffectGraph::Preset::Standard);
+  targetGraph = graph;
+  graphSlots.fill(graph);
+  graphFade.setCurrentAndTargetValue(1.0f);
+  for (auto &fade : nodeFades)
+    fade.setCurrentAndTargetValue(1.0f);
+  nodeFadeStart.fill(1.0f);
+  nodeFadeEnd.fill(1.0f);
 }
 
 EffectsProcessor::~EffectsProcessor() {}
 
-void EffectsProcessor::prepare(juce::dsp::ProcessSpec &spec) {
+void EffectsProcessor::prepare(juce::dsp::ProcessSpec &spec,
+                               ScratchArena &scratchArena) {
   currentSampleRate = spec.sampleRate;
-
-  // Prepare Distortion
-  distortion.prepare(spec);
-  distDriveParam.reset(currentSampleRate, 0.05); // 50ms ramp
-  distMixParam.reset(currentSampleRate, 0.05);
-
-  // Prepare Transient Shaper
-  transientShaper.prepare(spec);
+  preparedSpec = spec;
+  scratch = &scratchArena;
+
+  // Short enough to pass for a hiccup, long enough not to click
+  graphFade.reset(currentSampleRate, 0.005);
+  graphFade.setCurrentAndTargetValue(1.0f);
+  for (auto &fade : nodeFades) {
+    fade.reset(currentSampleRate, 0.01);
+    fade.setCurrentAndTargetValue(1.0f);
+  }
+  nodeFadeStart.fill(1.0f);
+  nodeFadeEnd.fill(1.0f);
+  anyNodeFading = false;
+
+  // Distortion, bitcrusher and transient shaper run at the oversampled rate
+  oversampler.prepare(spec);
+  oversampling = requestedOversampling;
+  updateOversamplingFactor();
+  shaperLookaheadSamples =
+      juce::roundToInt(shaperLookaheadSeconds * currentSampleRate);
+  shaperLookahead = requestedShaperLookahead;
+  constexpr int maxFactor = 1 << (EffectsOversampler::numFactors - 1);
+  transientShaper.setMaximumLookahead(shaperLookaheadSamples * maxFactor);
+  updateStageRates();
+  nodeFadeInput.setSize(2, (int)spec.maximumBlockSize * maxFactor);
+
+  // Longest the effects can delay the dry signal, plus a block
+  const int maxLatency =
+      oversampler.getMaxLatencySamples() + shaperLookaheadSamples + 1;
+  const int dryLineSize =
+      juce::nextPowerOfTwo(maxLatency + (int)spec.maximumBlockSize + 1);
+  dryLine.setSize(2, dryLineSize);
+  dryLine.clear();
+  dryLineMask = dryLineSize - 1;
+  dryLinePos = 0;
+  dryBuffer.setSize(2, (int)spec.maximumBlockSize);
 
   // Prepare Delay
-  delayLine.prepare(spec);
-  // Important: Set correct max delay based on sample rate
-  delayLine.setMaximumDelayInSamples(
-      static_cast<int>(spec.sampleRate * maxDelayTime));
-  delayLine.reset();
-
-  delayTimeParam.reset(currentSampleRate,
-                       0.5); // Slower ramp for delay time to avoid pitch jumps?
-                             // Actually fast ramp + interpolation is better for
-                             // "swoop". 0.05 is standard.
-  delayTimeParam.reset(currentSampleRate, 0.05);
-  delayFeedbackParam.reset(currentSampleRate, 0.05);
-  delayMixParam.reset(currentSampleRate, 0.05);
+  delay.prepare(spec, scratchArena);
 
   // Prepare Reverb
   reverb.prepare(spec);
-  reverb.reset();
-  reverbMixParam.reset(currentSampleRate, 0.05);
-
-  // Prepare Analysis Filters
-  meterFilterLow.prepare(spec);
-  meterFilterLow.setType(juce::dsp::StateVariableTPTFilterType::lowpass);
-  meterFilterLow.setCutoffFrequency(300.0f); // Low band < 300Hz
-
-  meterFilterMid.prepare(spec);
-  meterFilterMid.setType(juce::dsp::StateVariableTPTFilterType::bandpass);
-  meterFilterMid.setCutoffFrequency(1000.0f); // Mid band center 1kHz
-
-  meterFilterHigh.prepare(spec);
-  meterFilterHigh.setType(juce::dsp::StateVariableTPTFilterType::highpass);
-  meterFilterHigh.setCutoffFrequency(5000.0f); // High band > 5kHz
+  convolution.prepare(spec);
+
+  // Delay and FDN wet signals can run at 1/2 or 1/4 rate
+  const int lowRateSize = HalfBandResampler::getMaxLowRateSamples(
+      (int)spec.maximumBlockSize);
+  for (auto &path : wetPaths) {
+    path.resampler.prepare((int)spec.maximumBlockSize);
+    path.input.setSize(HalfBandResampler::maxChannels, lowRateSize);
+    path.wet.setSize(HalfBandResampler::maxChannels, lowRateSize);
+    path.work.setSize(HalfBandResampler::maxChannels, lowRateSize);
+  }
+  wetFactor = requestedWetFactor;
+  updateWetPathRate();
 
-  // Reserve ramp buffer
-  rampBuffer.reserve(spec.maximumBlockSize);
+  // Parallel branches can share the work with a helper thread, restarted
+  // here for the new block period
+  branchJob.owner = this;
+  {
+    const juce::ScopedLock sl(helperLock);
+    helper.stop();
+    helperPeriodMs = 1000.0 * spec.maximumBlockSize / spec.sampleRate;
+  }
+  updateHelperThread();
 
-  // Preallocate metering scratch buffers
-  const int channels = (int)spec.numChannels;
-  const int maxBlock = (int)spec.maximumBlockSize;
-  meterScratchLow.setSize(channels, maxBlock, false, false, true);
-  meterScratchMid.setSize(channels, maxBlock, false, false, true);
-  meterScratchHigh.setSize(channels, maxBlock, false, false, true);
+  // Metering runs on the UI thread from a decimated copy
+  analyser.prepare(spec.sampleRate);
 }
 
 void EffectsProcessor::reset() {
-  distortion.reset();
+  resetDistortion();
   transientShaper.reset();
-  delayLine.reset();
+  oversampler.reset();
+  delay.reset();
   reverb.reset();
+  convolution.reset();
+  for (auto &path : wetPaths)
+    path.resampler.reset();
 
-  meterFilterLow.reset();
-  meterFilterMid.reset();
-  meterFilterHigh.reset();
   bitcrushPhase = 0.0f;
-  lastCrushedSampleL = 0.0f;
-  lastCrushedSampleR = 0.0f;
+  crushHold = {};
 
   // Reset smoothers to target ?? No, usually just keep current.
 }
@@ -90,219 +111,905 @@ void EffectsProcessor::updateParameters(float distDrive, float distMix,
   distMixParam.setTargetValue(distMix);
   transientShaper.setAmount(biteAmount); // Shaper handles its own smoothing
 
-  delayTimeParam.setTargetValue(delayTime);
-  delayFeedbackParam.setTargetValue(delayFeedback);
-  delayMixParam.setTargetValue(delayMix);
+  delay.setParameters(delayTime, delayFeedback, delayMix);
+
+  // SIZE scales the room (line lengths), DECAY sets the RT60
+  reverb.setParameters(reverbSize, reverbDecay, reverbDamping, reverbMix);
 
-  // Map Reverb params
-  // JUCE Reverb doesn't expose a direct "decay time" parameter.
-  // We map DECAY -> roomSize and SIZE -> stereo width to keep both controls
-  // meaningful and independent.
-  reverbParams.roomSize = reverbDecay;
-  reverbParams.damping = reverbDamping;
+  // Tail: delay repeats until the feedback has dropped 60 dB, then the reverb
+  // rings out for its RT60
+  double tail = 0.0;
+  if (delayMix > 0.0f && delayTime > 0.0f) {
+    const double fb = juce::jlimit(0.0, 0.99, (double)delayFeedback);
+    const double repeats = fb > 0.001 ? std::ceil(-3.0 / std::log10(fb)) : 0.0;
+    tail += delayTime * (repeats + 1.0);
+  }
+  if (reverbMix > 0.0f)
+    tail += reverb.getDecaySeconds();
+  tailLengthSeconds = tail;
+}
 
-  // Revert to internal mixing to ensure Dry/Wet balance works without temp
-  // buffer
-  reverbParams.wetLevel = reverbMix;
-  reverbParams.dryLevel = 1.0f - reverbMix;
+void EffectsProcessor::setConvolution(float mix, int space) {
+  convolution.setMix(juce::jlimit(0.0f, 1.0f, mix));
+  convolution.setSpace((ConvolutionReverb::Space)juce::jlimit(0, 2, space));
+  convolutionTailSeconds =
+      mix > 0.0f ? convolution.getTailLengthSeconds() : 0.0;
+}
 
-  reverbParams.width = reverbSize;
-  reverbParams.freezeMode = 0.0f;
+bool EffectsProcessor::isIdle() const {
+  return oversampler.isIdle() && transientShaper.isIdle() && delay.isIdle() &&
+         reverb.isIdle() && convolution.isIdle() && !isBitcrusherHolding();
+}
 
-  reverb.setParameters(reverbParams);
-  reverbMixParam.setTargetValue(
-      reverbMix); // Keep for the on/off check in processReverb
+bool EffectsProcessor::isBitcrusherHolding() const {
+  // A bypassed bitcrusher is reset, so its hold is zero
+  return crushHold.left() != 0.0f || crushHold.right() != 0.0f;
 }
 
-void EffectsProcessor::process(juce::AudioBuffer<float> &buffer) {
-  juce::ScopedNoDenormals noDenormals;
+void EffectsProcessor::skipSmoothers(int numSamples) {
+  const int stageSamples = numSamples * oversampler.getFactor();
+  distDriveParam.skip(stageSamples);
+  distMixParam.skip(stageSamples);
+  transientShaper.skipSilence(stageSamples);
+  oversampler.skipSilence(numSamples);
+  delay.skip(numSamples / wetFactor);
+  reverb.skip(numSamples / wetFactor);
+  convolution.skip(numSamples);
+}
 
-  for (auto effect : chainOrder) {
-    switch (effect) {
-    case EffectType::Distortion:
-      processDistortion(buffer);
-      // Bitcrusher is logically part of Distortion block in this context
-      if (bitcrushEnabled) {
-        processBitcrusher(buffer);
+void EffectsProcessor::setGraph(const EffectGraph &newGraph) {
+  graphSlots[(size_t)writerSlot] = newGraph;
+  writerSlot = sharedSlot.exchange(writerSlot | freshGraph) & graphSlotMask;
+
+  {
+    const juce::ScopedLock sl(helperLock);
+    helperNeeded = hasParallelWork(newGraph);
+  }
+  updateHelperThread();
+}
+
+void EffectsProcessor::setHelperThreadEnabled(bool enabled) {
+  {
+    const juce::ScopedLock sl(helperLock);
+    helperThreadEnabled = enabled;
+  }
+  updateHelperThread();
+}
+
+bool EffectsProcessor::hasParallelWork(const EffectGraph &layout) {
+  for (int s = 0; s < layout.getNumStages(); ++s) {
+    const auto &stage = layout.getStage(s);
+    int busyBranches = 0;
+    for (int b = 0; b < stage.numBranches; ++b) {
+      const auto &branch = stage.branches[(size_t)b];
+      for (int n = 0; n < branch.numNodes; ++n) {
+        if (layout.isActive(branch.nodes[(size_t)n])) {
+          ++busyBranches;
+          break;
+        }
       }
-      break;
-    case EffectType::TransientShaper:
-      processTransientShaper(buffer);
-      break;
-    case EffectType::Delay:
-      processDelay(buffer);
-      break;
-    case EffectType::Reverb:
-      processReverb(buffer);
-      break;
     }
+    if (busyBranches > 1)
+      return true;
   }
+  return false;
+}
 
-  // Metering after all effects (or strictly after distortion? User said
-  // "DISTORTION EQ") But if it's "Effects Tab" metering, user probably wants to
-  // see the overall spectrum. However, "DISTORTION EQ" implies it visualizes
-  // the distortion character. Let's measure effectively after the
-  // Distortion/Shaper block, but before Delay/Reverb to be accurate "Distortion
-  // EQ" Wait, the loop processes in mutable order. I should probably analyze
-  // *at the end of processDistortion*? But if the chain order is reversed
-  // (Reverb -> Distortion), measuring at the end of the whole chain is safer to
-  // be visible. But strictly "Distortion EQ" implies shaping. I will measure at
-  // the VERY END of the chain so the user sees "Output Spectrum".
-  processMetering(buffer);
+void EffectsProcessor::updateHelperThread() {
+  const juce::ScopedLock sl(helperLock);
+  const bool wanted =
+      helperThreadEnabled && helperNeeded && helperPeriodMs > 0.0;
+  if (wanted && !helper.isStarted())
+    helper.start(helperPeriodMs);
+  else if (!wanted && helper.isStarted())
+    helper.stop();
 }
 
-void EffectsProcessor::processBitcrusher(juce::AudioBuffer<float> &buffer) {
-  // Simple Bitcrush/Downsample
-  // Downsample factor: 4x (roughly 11kHz SR)
-  // Bit depth: 8 bit via truncation
-  float downsampleFactor = 4.0f;
-  int numSamples = buffer.getNumSamples();
-  auto *ch0 = buffer.getWritePointer(0);
-  auto *ch1 = buffer.getNumChannels() > 1 ? buffer.getWritePointer(1) : nullptr;
+void EffectsProcessor::updateGraph(bool idle, int numSamples) {
+  if ((sharedSlot.load() & freshGraph) != 0) {
+    readerSlot = sharedSlot.exchange(readerSlot) & graphSlotMask;
+    targetGraph = graphSlots[(size_t)readerSlot];
+  }
 
-  for (int i = 0; i < numSamples; ++i) {
-    bitcrushPhase += 1.0f;
-    if (bitcrushPhase >= downsampleFactor) {
-      bitcrushPhase -= downsampleFactor;
+  if (!graphSwapPending && needsGraphSwap()) {
+    graphSwapPending = true;
+    graphFade.setTargetValue(0.0f);
+  }
 
-      // Quantize
-      float sample = ch0[i];
-      float levels = 256.0f; // 8 bit
-      sample = std::round(sample * levels) / levels;
-      lastCrushedSampleL = sample;
-
-      if (ch1) {
-        float sampleR = ch1[i];
-        sampleR = std::round(sampleR * levels) / levels;
-        lastCrushedSampleR = sampleR;
+  // Silence needs no fade; otherwise swap once the output is all dry
+  if (graphSwapPending) {
+    if (idle) {
+      adoptTargetGraph();
+      graphFade.setCurrentAndTargetValue(1.0f);
+    } else if (graphFade.getCurrentValue() <= 0.0f) {
+      adoptTargetGraph();
+      graphFade.setTargetValue(1.0f);
+    }
+  }
+
+  updateNodeFades(idle || graphSwapPending, numSamples);
+}
+
+bool EffectsProcessor::needsGraphSwap() const {
+  // A new wet rate restarts the delay and reverb, and the shaper's lookahead
+  // and the oversampling filters move the audio in time
+  if (requestedWetFactor != wetFactor ||
+      requestedShaperLookahead != shaperLookahead ||
+      requestedOversampling != oversampling ||
+      requestedDistortionOrder != distortion.getOrder() ||
+      !targetGraph.hasSameLayout(graph))
+    return true;
+  if (targetGraph == graph)
+    return false;
+
+  // Switching nodes on and off can also move the audio in time, if it
+  // changes the latency at either end of the fade or while both are on
+  auto bothOn = targetGraph;
+  for (int n = 0; n < EffectGraph::numNodeTypes; ++n)
+    if (graph.isActive((EffectType)n))
+      bothOn.setBypassed((EffectType)n, false);
+
+  const int factorIndex = getOversamplingFactorIndex(graph);
+  const auto shaper = EffectType::TransientShaper;
+  return getOversamplingFactorIndex(targetGraph) != factorIndex ||
+         getOversamplingFactorIndex(bothOn) != factorIndex ||
+         getDistortionLatency(targetGraph) != getDistortionLatency(graph) ||
+         (shaperLookahead &&
+          targetGraph.isActive(shaper) != graph.isActive(shaper));
+}
+
+void EffectsProcessor::adoptTargetGraph() {
+  graphSwapPending = false;
+
+  if (requestedWetFactor != wetFactor) {
+    wetFactor = requestedWetFactor;
+    updateWetPathRate();
+  }
+
+  if (requestedShaperLookahead != shaperLookahead) {
+    shaperLookahead = requestedShaperLookahead;
+    updateShaperLookahead();
+  }
+
+  if (requestedDistortionOrder != distortion.getOrder()) {
+    distortion.setOrder(requestedDistortionOrder);
+    distDryHeld = false;
+  }
+
+  // Nodes leaving the path drop their state rather than hold a tail that
+  // would play out when they come back
+  for (int n = 0; n < EffectGraph::numNodeTypes; ++n) {
+    const auto node = (EffectType)n;
+    if (graph.isActive(node) && !targetGraph.isActive(node))
+      resetNode(node);
+    nodeFades[(size_t)n].setCurrentAndTargetValue(1.0f);
+  }
+
+  graph = targetGraph;
+  oversampling = requestedOversampling;
+  updateOversamplingFactor();
+}
+
+void EffectsProcessor::updateNodeFades(bool immediate, int numSamples) {
+  // Only bypass changes are left between graph and targetGraph here (or
+  // nothing, with a swap on its way)
+  bool layoutChanged = false;
+  anyNodeFading = false;
+
+  for (int n = 0; n < EffectGraph::numNodeTypes; ++n) {
+    const auto node = (EffectType)n;
+    auto &fade = nodeFades[(size_t)n];
+    const bool wanted = targetGraph.isActive(node);
+
+    if (graph.isActive(node) != wanted && !graphSwapPending) {
+      if (wanted) {
+        // Coming in from a reset, so from silence
+        graph.setBypassed(node, false);
+        fade.setCurrentAndTargetValue(0.0f);
+        layoutChanged = true;
+      } else if (fade.getCurrentValue() <= 0.0f) {
+        graph.setBypassed(node, true);
+        resetNode(node);
+        fade.setCurrentAndTargetValue(1.0f);
+        layoutChanged = true;
       }
     }
 
-    ch0[i] = lastCrushedSampleL;
-    if (ch1)
-      ch1[i] = lastCrushedSampleR;
+    fade.setTargetValue(wanted || graphSwapPending ? 1.0f : 0.0f);
+    if (immediate)
+      fade.setCurrentAndTargetValue(fade.getTargetValue());
+
+    nodeFadeStart[(size_t)n] = fade.getCurrentValue();
+    nodeFadeEnd[(size_t)n] = fade.skip(numSamples);
+    anyNodeFading = anyNodeFading || isNodeFading(node);
   }
+
+  // Same factor (needsGraphSwap() made sure), so the stages don't restart
+  if (layoutChanged)
+    updateOversamplingFactor();
 }
 
-void EffectsProcessor::processMetering(const juce::AudioBuffer<float> &buffer) {
+bool EffectsProcessor::beginNodeFade(EffectType node,
+                                     const juce::AudioBuffer<float> &buffer) {
   const int numSamples = buffer.getNumSamples();
-  const int numChannels = buffer.getNumChannels();
+  if (!isNodeFading(node) || numSamples > nodeFadeInput.getNumSamples())
+    return false;
+
+  for (int ch = 0; ch < juce::jmin(2, buffer.getNumChannels()); ++ch)
+    nodeFadeInput.copyFrom(ch, 0, buffer, ch, 0, numSamples);
+  return true;
+}
+
+void EffectsProcessor::endNodeFade(EffectType node,
+                                   juce::AudioBuffer<float> &buffer) {
+  // input + (output - input) * fade
+  const float start = nodeFadeStart[(size_t)node];
+  const float end = nodeFadeEnd[(size_t)node];
+  const int numSamples = buffer.getNumSamples();
+  for (int ch = 0; ch < juce::jmin(2, buffer.getNumChannels()); ++ch) {
+    buffer.applyGainRamp(ch, 0, numSamples, start, end);
+    buffer.addFromWithRamp(ch, 0, nodeFadeInput.getReadPointer(ch),
+                           numSamples, 1.0f - start, 1.0f - end);
+  }
+}
+
+void EffectsProcessor::processNode(EffectType node,
+                                   juce::AudioBuffer<float> &buffer,
+                                   bool &silent) {
+  const bool fading = beginNodeFade(node, buffer);
+  processEffect(node, buffer, silent);
+  if (fading)
+    endNodeFade(node, buffer);
+}
+
+void EffectsProcessor::delayDry(const juce::AudioBuffer<float> &buffer,
+                                bool readBack) {
+  const int numSamples = buffer.getNumSamples();
+  const int numChannels = juce::jmin(2, buffer.getNumChannels());
+  const int size = dryLineMask + 1;
+  const int readPos = (dryLinePos - getLatencySamples()) & dryLineMask;
+
+  for (int ch = 0; ch < numChannels; ++ch) {
+    const float *input = buffer.getReadPointer(ch);
+    float *line = dryLine.getWritePointer(ch);
+    const int first = juce::jmin(numSamples, size - dryLinePos);
+    std::copy(input, input + first, line + dryLinePos);
+    std::copy(input + first, input + numSamples, line);
+
+    if (readBack) {
+      float *dry = dryBuffer.getWritePointer(ch);
+      const int firstRead = juce::jmin(numSamples, size - readPos);
+      std::copy(line + readPos, line + readPos + firstRead, dry);
+      std::copy(line, line + numSamples - firstRead, dry + firstRead);
+    }
+  }
+  dryLinePos = (dryLinePos + numSamples) & dryLineMask;
+}
 
-  if (numSamples <= 0 || numChannels <= 0)
+void EffectsProcessor::resetNode(EffectType node) {
+  switch (node) {
+  case EffectType::Distortion:
+    resetDistortion();
+    break;
+  case EffectType::Bitcrusher:
+    bitcrushPhase = 0.0f;
+    crushHold = {};
+    break;
+  case EffectType::TransientShaper:
+    transientShaper.reset();
+    break;
+  case EffectType::Delay:
+    delay.reset();
+    break;
+  case EffectType::Reverb:
+    reverb.reset();
+    convolution.reset();
+    break;
+  }
+}
+
+void EffectsProcessor::findOversampledStages(const EffectGraph &layout,
+                                             int &first, int &last) {
+  // The active nonlinear nodes share one pass through the oversampler, so
+  // they must fill a run of serial stages with nothing else active between
+  first = last = -1;
+  bool runClosed = false, wrappable = true;
+
+  for (int s = 0; s < layout.getNumStages(); ++s) {
+    const auto &stage = layout.getStage(s);
+    bool hasNonlinear = false, hasOther = false;
+    for (int b = 0; b < stage.numBranches; ++b) {
+      const auto &branch = stage.branches[(size_t)b];
+      for (int n = 0; n < branch.numNodes; ++n) {
+        const auto node = branch.nodes[(size_t)n];
+        if (layout.isActive(node))
+          (isNonlinear(node) ? hasNonlinear : hasOther) = true;
+      }
+    }
+
+    if (hasNonlinear) {
+      if (runClosed || hasOther || !stage.isSerial())
+        wrappable = false;
+      if (first < 0)
+        first = s;
+      last = s + 1;
+    } else if (hasOther && first >= 0) {
+      runClosed = true;
+    }
+  }
+
+  if (!wrappable)
+    first = last = -1;
+}
+
+int EffectsProcessor::getOversamplingFactorIndex(
+    const EffectGraph &layout) const {
+  int first, last;
+  findOversampledStages(layout, first, last);
+  return first >= 0 ? oversampling : 0;
+}
+
+void EffectsProcessor::updateOversamplingFactor() {
+  findOversampledStages(graph, oversampledFirst, oversampledLast);
+
+  const int factorIndex = oversampledFirst >= 0 ? oversampling : 0;
+  if (oversampler.setFactorIndex(factorIndex))
+    updateStageRates();
+}
+
+void EffectsProcessor::updateStageRates() {
+  const int factor = oversampler.getFactor();
+  const double stageRate = currentSampleRate * factor;
+
+  resetDistortion();
+  distDriveParam.reset(stageRate, 0.05); // 50ms ramp
+  distMixParam.reset(stageRate, 0.05);
+
+  juce::dsp::ProcessSpec stageSpec = preparedSpec;
+  stageSpec.sampleRate = stageRate;
+  stageSpec.maximumBlockSize =
+      preparedSpec.maximumBlockSize * (juce::uint32)factor;
+  transientShaper.prepare(stageSpec);
+  updateShaperLookahead();
+}
+
+void EffectsProcessor::updateShaperLookahead() {
+  // The same time at any oversampling factor, so the latency stays put
+  transientShaper.setLookahead(
+      shaperLookahead ? shaperLookaheadSamples * oversampler.getFactor() : 0);
+}
+
+void EffectsProcessor::updateWetPathRate() {
+  // Both restart empty at the new rate
+  delay.setRateDivisor(wetFactor);
+  delay.setWetOnly(wetFactor > 1);
+  reverb.setRateDivisor(wetFactor);
+  reverb.setWetOnly(wetFactor > 1);
+  for (auto &path : wetPaths)
+    path.resampler.setFactor(wetFactor);
+}
+
+bool EffectsProcessor::isDistorting() const {
+  return distMixParam.getCurrentValue() > 0.0f ||
+         distMixParam.getTargetValue() > 0.0f;
+}
+
+bool EffectsProcessor::areNonlinearStagesActive() const {
+  return (graph.isActive(EffectType::Distortion) && isDistorting()) ||
+         graph.isActive(EffectType::Bitcrusher) ||
+         (graph.isActive(EffectType::TransientShaper) &&
+          transientShaper.isActive());
+}
+
+void EffectsProcessor::process(juce::AudioBuffer<float> &buffer) {
+  juce::ScopedNoDenormals noDenormals;
+  const int numSamples = buffer.getNumSamples();
+
+  // Silence passes straight through distortion and the shaper; only the delay
+  // and reverb can turn it into sound while they still have a tail
+  bool silent = buffer.getMagnitude(0, numSamples) < silenceThreshold;
+
+  const bool idle = silent && isIdle();
+  updateGraph(idle, numSamples);
+
+  if (idle) {
+    skipSmoothers(numSamples);
     return;
+  }
+
+  // Keep the dry input while a swap crossfades to it; with latency the line
+  // needs the history either way
+  const bool crossfading =
+      graphSwapPending || graphFade.getCurrentValue() < 1.0f;
+  const bool inputSilent = silent;
+  if (crossfading || getLatencySamples() > 0)
+    delayDry(buffer, crossfading);
+
+  const int numStages = graph.getNumStages();
+  const int oversampledStage =
+      oversampler.getFactor() > 1 ? oversampledFirst : -1;
+  for (int s = 0; s < numStages;) {
+    if (s == oversampledStage) {
+      processOversampled(buffer, oversampledFirst, oversampledLast, silent);
+      s = oversampledLast;
+      continue;
+    }
+
+    if (!graph.getStage(s).isSerial()) {
+      processStage(graph.getStage(s), buffer, silent);
+      ++s;
+      continue;
+    }
 
-  // Ensure scratch buffers are big enough (should already be sized in prepare)
-  if (meterScratchLow.getNumSamples() < numSamples ||
-      meterScratchLow.getNumChannels() < numChannels) {
-    meterScratchLow.setSize(numChannels, numSamples, false, false, true);
-    meterScratchMid.setSize(numChannels, numSamples, false, false, true);
-    meterScratchHigh.setSize(numChannels, numSamples, false, false, true);
+    // Back-to-back serial stages make one chain, so a delay and reverb in
+    // consecutive stages share the trip to the reduced rate
+    std::array<EffectType, EffectGraph::numNodeTypes> chain;
+    int chainLength = 0;
+    do {
+      const auto &branch = graph.getStage(s).branches[0];
+      for (int n = 0; n < branch.numNodes && chainLength < (int)chain.size();
+           ++n)
+        chain[(size_t)chainLength++] = branch.nodes[(size_t)n];
+      ++s;
+    } while (s < numStages && s != oversampledStage &&
+             graph.getStage(s).isSerial());
+    processChain(chain.data(), chainLength, buffer, silent);
   }
 
-  meterScratchLow.makeCopyOf(buffer, true);
-  meterScratchMid.makeCopyOf(buffer, true);
-  meterScratchHigh.makeCopyOf(buffer, true);
+  if (crossfading) {
+    const float startGain = graphFade.getCurrentValue();
+    const float endGain = graphFade.skip(numSamples);
+    for (int ch = 0; ch < juce::jmin(2, buffer.getNumChannels()); ++ch) {
+      buffer.applyGainRamp(ch, 0, numSamples, startGain, endGain);
+      buffer.addFromWithRamp(ch, 0, dryBuffer.getReadPointer(ch), numSamples,
+                             1.0f - startGain, 1.0f - endGain);
+    }
+    silent = silent && inputSilent;
+  }
 
-  {
-    juce::dsp::AudioBlock<float> lowBlock(meterScratchLow);
-    juce::dsp::ProcessContextReplacing<float> lowCtx(lowBlock);
-    meterFilterLow.process(lowCtx);
-    eqLow = meterScratchLow.getRMSLevel(0, 0, numSamples) * 5.0f;
+  // Metering after all effects. Silence isn't queued; the meters fall
+  // back on their own when nothing arrives.
+  if (!silent)
+    analyser.push(buffer);
+}
+
+void EffectsProcessor::processStage(const EffectGraph::Stage &stage,
+                                    juce::AudioBuffer<float> &buffer,
+                                    bool &silent) {
+  if (stage.isSerial()) {
+    processBranch(stage.branches[0], buffer, silent);
+    return;
   }
 
-  {
-    juce::dsp::AudioBlock<float> midBlock(meterScratchMid);
-    juce::dsp::ProcessContextReplacing<float> midCtx(midBlock);
-    meterFilterMid.process(midCtx);
-    eqMid = meterScratchMid.getRMSLevel(0, 0, numSamples) * 5.0f;
+  // Parallel: every branch starts from the stage input, and the output is
+  // the input plus each branch's change. Each branch
+  // renders into its own copy and the changes are summed in branch order
+  // afterwards, so the result is the same whichever thread ran a branch.
+  const int numSamples = buffer.getNumSamples();
+  const int numChannels = juce::jmin(buffer.getNumChannels(), 2);
+  const int numBranches = stage.numBranches;
+  const ScratchArena::Scope scratchScope(*scratch);
+  float *input[2];
+  float *work[EffectGraph::maxBranches][2];
+  bool allocated = scratch->allocateChannels(input, numChannels, numSamples);
+  for (int b = 0; b < numBranches && allocated; ++b)
+    allocated = scratch->allocateChannels(work[b], numChannels, numSamples);
+  if (!allocated) {
+    for (int b = 0; b < numBranches; ++b)
+      processBranch(stage.branches[(size_t)b], buffer, silent);
+    return;
   }
 
-  {
-    juce::dsp::AudioBlock<float> highBlock(meterScratchHigh);
-    juce::dsp::ProcessContextReplacing<float> highCtx(highBlock);
-    meterFilterHigh.process(highCtx);
-    eqHigh = meterScratchHigh.getRMSLevel(0, 0, numSamples) * 5.0f;
+  for (int ch = 0; ch < numChannels; ++ch) {
+    juce::FloatVectorOperations::copy(input[ch], buffer.getReadPointer(ch),
+                                      numSamples);
+    for (int b = 0; b < numBranches; ++b)
+      juce::FloatVectorOperations::copy(work[b][ch], input[ch], numSamples);
+  }
+
+  // The last branch goes to the helper thread while this one renders the
+  // rest. Only the delay draws on the scratch arena inside a branch, and
+  // there is one delay, so the two threads never use the arena at once.
+  const int helperBranch = numBranches - 1;
+  const bool offload = helper.isAvailable() && numBranches > 1 &&
+                       !anyNodeFading &&
+                       hasActiveNode(stage.branches[0]) &&
+                       hasActiveNode(stage.branches[(size_t)helperBranch]);
+  bool branchSilent[EffectGraph::maxBranches];
+  if (offload) {
+    branchJob.branch = &stage.branches[(size_t)helperBranch];
+    branchJob.buffer.setDataToReferTo(work[helperBranch], numChannels,
+                                      numSamples);
+    branchJob.silent = silent;
+    helper.post(branchJob);
   }
+
+  for (int b = 0; b < (offload ? helperBranch : numBranches); ++b) {
+    juce::AudioBuffer<float> branchBuffer(work[b], numChannels, numSamples);
+    branchSilent[b] = silent;
+    processBranch(stage.branches[(size_t)b], branchBuffer, branchSilent[b]);
+  }
+
+  if (offload) {
+    helper.join();
+    branchSilent[helperBranch] = branchJob.silent;
+  }
+
+  bool stageSilent = silent;
+  for (int b = 0; b < numBranches; ++b) {
+    // Silence in and out: the branch changed nothing
+    if (branchSilent[b])
+      continue;
+
+    stageSilent = false;
+    for (int ch = 0; ch < numChannels; ++ch) {
+      float *out = buffer.getWritePointer(ch);
+      juce::FloatVectorOperations::add(out, work[b][ch], numSamples);
+      juce::FloatVectorOperations::subtract(out, input[ch], numSamples);
+    }
+  }
+  silent = stageSilent;
 }
 
-void EffectsProcessor::processDistortion(juce::AudioBuffer<float> &buffer) {
-  auto totalNumInputChannels = buffer.getNumChannels();
-  auto numSamples = buffer.getNumSamples();
+bool EffectsProcessor::hasActiveNode(const EffectGraph::Branch &branch) const {
+  for (int n = 0; n < branch.numNodes; ++n)
+    if (graph.isActive(branch.nodes[(size_t)n]))
+      return true;
+  return false;
+}
 
-  auto *ch0 = buffer.getWritePointer(0);
-  auto *ch1 = (totalNumInputChannels > 1) ? buffer.getWritePointer(1) : nullptr;
+void EffectsProcessor::processBranch(const EffectGraph::Branch &branch,
+                                     juce::AudioBuffer<float> &buffer,
+                                     bool &silent) {
+  processChain(branch.nodes.data(), branch.numNodes, buffer, silent);
+}
 
-  for (int i = 0; i < numSamples; ++i) {
-    float drive = distDriveParam.getNextValue();
-    float mix = distMixParam.getNextValue();
+void EffectsProcessor::processChain(const EffectType *nodes, int numNodes,
+                                    juce::AudioBuffer<float> &buffer,
+                                    bool &silent) {
+  for (int n = 0; n < numNodes;) {
+    const auto node = nodes[n];
+    if (!graph.isActive(node)) {
+      ++n;
+      continue;
+    }
 
-    // Hunt Mode Logic ("Hunt" button essentially boosts Input Drive)
-    if (huntEnabled) {
-      drive = std::min(drive * 1.5f + 0.2f, 1.0f);
+    if (wetFactor > 1 && isWetNode(node)) {
+      // The run carries on over bypassed nodes
+      EffectType run[EffectGraph::numNodeTypes];
+      int runLength = 0;
+      for (; n < numNodes && (isWetNode(nodes[n]) || !graph.isActive(nodes[n]));
+           ++n)
+        if (graph.isActive(nodes[n]))
+          run[runLength++] = nodes[n];
+
+      processReducedRate(run, runLength, buffer, silent);
+      continue;
+    }
+
+    processNode(node, buffer, silent);
+    ++n;
+  }
+}
+
+void EffectsProcessor::processReducedRate(const EffectType *run,
+                                          int runLength,
+                                          juce::AudioBuffer<float> &buffer,
+                                          bool &silent) {
+  const int numSamples = buffer.getNumSamples();
+  const int numChannels =
+      juce::jmin(buffer.getNumChannels(), HalfBandResampler::maxChannels);
+  auto &path = wetPaths[run[0] == EffectType::Delay ? 0 : 1];
+
+  bool hasReverb = false, runIdle = true;
+  for (int n = 0; n < runLength; ++n) {
+    const bool isDelay = run[n] == EffectType::Delay;
+    hasReverb = hasReverb || !isDelay;
+    runIdle = runIdle && (isDelay ? delay.isIdle() : reverb.isIdle());
+  }
+
+  if (silent && runIdle) {
+    // Whatever the filters still hold is below the silence threshold
+    path.resampler.reset();
+    for (int n = 0; n < runLength; ++n) {
+      if (run[n] == EffectType::Delay)
+        delay.skip(numSamples / wetFactor);
+      else
+        reverb.skip(numSamples / wetFactor);
     }
+  } else {
+    // The low-rate buffers hold one prepared block, so a longer one goes
+    // down and back in pieces
+    const bool inputSilent = silent;
+    const int maxLength = (int)preparedSpec.maximumBlockSize;
+    for (int start = 0; start < numSamples; start += maxLength) {
+      juce::AudioBuffer<float> slice(buffer.getArrayOfWritePointers(),
+                                     numChannels, start,
+                                     juce::jmin(maxLength, numSamples - start));
+      if (processWetPath(run, runLength, path, slice, inputSilent))
+        silent = false;
+    }
+  }
+
+  if (hasReverb) {
+    const bool fading = beginNodeFade(EffectType::Reverb, buffer);
+    if (convolution.process(buffer, silent))
+      silent = false;
+    if (fading)
+      endNodeFade(EffectType::Reverb, buffer);
+  }
+}
 
-    float gain = 1.0f + (drive * 49.0f);
+bool EffectsProcessor::processWetPath(const EffectType *run, int runLength,
+                                      WetPath &path,
+                                      juce::AudioBuffer<float> &buffer,
+                                      bool silent) {
+  const int numSamples = buffer.getNumSamples();
+  const int numChannels = buffer.getNumChannels();
+  float *const *input = path.input.getArrayOfWritePointers();
+  float *const *wet = path.wet.getArrayOfWritePointers();
+  const int lowSamples = path.resampler.decimate(
+      buffer.getArrayOfReadPointers(), input, numChannels, numSamples);
+  for (int ch = 0; ch < numChannels; ++ch)
+    juce::FloatVectorOperations::clear(wet[ch], lowSamples);
+
+  // So far the run's output is dry * input + wet, the dry gain ramping
+  // from dryStart to dryEnd over the block
+  float dryStart = 1.0f, dryEnd = 1.0f;
+  bool wetSilent = true;
+
+  for (int n = 0; n < runLength; ++n) {
+    juce::AudioBuffer<float> work(path.work.getArrayOfWritePointers(),
+                                  numChannels, lowSamples);
+    for (int ch = 0; ch < numChannels; ++ch) {
+      work.copyFrom(ch, 0, input[ch], lowSamples);
+      work.applyGainRamp(ch, 0, lowSamples, dryStart, dryEnd);
+      work.addFrom(ch, 0, wet[ch], lowSamples);
+    }
 
-    float dry0 = ch0[i];
-    float wet0 = std::tanh(dry0 * gain);
-    ch0[i] = (dry0 * (1.0f - mix)) + (wet0 * mix);
+    // A node fading in or out scales its wet, and its mix with it
+    const bool nodeSilent = silent && wetSilent;
+    const float fadeStart = nodeFadeStart[(size_t)run[n]];
+    const float fadeEnd = nodeFadeEnd[(size_t)run[n]];
+    bool wrote = false;
+    if (run[n] == EffectType::Delay) {
+      wrote = delay.process(work, nodeSilent);
+    } else {
+      // The reverb keeps 1 - mix of everything that went in
+      const float mixStart = reverb.getMix() * fadeStart;
+      wrote = reverb.process(work, nodeSilent);
+      const float mixEnd = reverb.getMix() * fadeEnd;
+
+      for (int ch = 0; ch < numChannels; ++ch)
+        path.wet.applyGainRamp(ch, 0, lowSamples, 1.0f - mixStart,
+                               1.0f - mixEnd);
+      dryStart *= 1.0f - mixStart;
+      dryEnd *= 1.0f - mixEnd;
+    }
 
-    if (ch1) {
-      float dry1 = ch1[i];
-      float wet1 = std::tanh(dry1 * gain);
-      ch1[i] = (dry1 * (1.0f - mix)) + (wet1 * mix);
+    if (wrote) {
+      for (int ch = 0; ch < numChannels; ++ch) {
+        if (fadeStart < 1.0f || fadeEnd < 1.0f)
+          work.applyGainRamp(ch, 0, lowSamples, fadeStart, fadeEnd);
+        juce::FloatVectorOperations::add(wet[ch], work.getReadPointer(ch),
+                                         lowSamples);
+      }
+      wetSilent = false;
     }
   }
+
+  for (int ch = 0; ch < numChannels; ++ch)
+    buffer.applyGainRamp(ch, 0, numSamples, dryStart, dryEnd);
+  path.resampler.addInterpolated(path.wet.getArrayOfReadPointers(),
+                                 buffer.getArrayOfWritePointers(),
+                                 numChannels, numSamples);
+  return !wetSilent;
+}
+
+void EffectsProcessor::processOversampled(juce::AudioBuffer<float> &buffer,
+                                          int firstStage, int lastStage,
+                                          bool &silent) {
+  const int numSamples = buffer.getNumSamples();
+  oversampler.noteInput(silent, numSamples);
+
+  // With nothing to shape, or once the filters have flushed after the input
+  // went quiet, a plain delay of the same length stands in for the filters
+  const bool flushed = silent && oversampler.isIdle() &&
+                       transientShaper.isIdle() && !isBitcrusherHolding();
+  if (flushed || !areNonlinearStagesActive()) {
+    const int stageSamples = numSamples * oversampler.getFactor();
+    skipDistortion(stageSamples);
+    transientShaper.skipSilence(stageSamples);
+    oversampler.bypass(buffer);
+  } else {
+    auto upsampled = oversampler.processUp(buffer);
+
+    // The filters ring on for a moment after the input falls silent
+    bool upSilent =
+        silent && upsampled.getMagnitude(0, upsampled.getNumSamples()) <
+                      silenceThreshold;
+    // Any split inside the run has every node bypassed
+    for (int s = firstStage; s < lastStage; ++s)
+      if (graph.getStage(s).isSerial())
+        processStage(graph.getStage(s), upsampled, upSilent);
+
+    oversampler.processDown(buffer);
+  }
+
+  // The delayed output may still carry sound from before a silent input
+  silent = buffer.getMagnitude(0, numSamples) < silenceThreshold;
+}
+
+void EffectsProcessor::processEffect(EffectType effect,
+                                     juce::AudioBuffer<float> &buffer,
+                                     bool &silent) {
+  const int numSamples = buffer.getNumSamples();
+
+  switch (effect) {
+  case EffectType::Distortion:
+    // At a mix held at zero the output is the input, lined up in time
+    if (silent)
+      skipDistortion(numSamples);
+    else if (!isDistorting())
+      holdDistortion(buffer);
+    else
+      processDistortion(buffer);
+    break;
+  case EffectType::Bitcrusher:
+    // It holds its last sample, so it only sleeps once that hold is zero
+    if (silent && !isBitcrusherHolding())
+      break;
+    processBitcrusher(buffer);
+    if (isBitcrusherHolding())
+      silent = false;
+    break;
+  case EffectType::TransientShaper:
+    // The lookahead line may still be playing out sound
+    if (transientShaper.process(buffer, silent))
+      silent = false;
+    break;
+  case EffectType::Delay:
+    if (delay.process(buffer, silent))
+      silent = false;
+    break;
+  case EffectType::Reverb:
+    if (reverb.process(buffer, silent))
+      silent = false;
+    if (convolution.process(buffer, silent))
+      silent = false;
+    break;
+  }
 }
 
-void EffectsProcessor::processTransientShaper(
-    juce::AudioBuffer<float> &buffer) {
-  transientShaper.process(buffer);
+void EffectsProcessor::skipDistortion(int numSamples) {
+  distDriveParam.skip(numSamples);
+  distMixParam.skip(numSamples);
+  resetDistortion();
 }
 
-void EffectsProcessor::processDelay(juce::AudioBuffer<float> &buffer) {
-  auto totalNumInputChannels = buffer.getNumChannels();
-  auto numSamples = buffer.getNumSamples();
+void EffectsProcessor::holdDistortion(juce::AudioBuffer<float> &buffer) {
+  const int numChannels = juce::jmin(buffer.getNumChannels(), 2);
+  const int numSamples = buffer.getNumSamples();
+  float *const *channels = buffer.getArrayOfWritePointers();
+
+  distDriveParam.skip(numSamples);
+  distMixParam.skip(numSamples);
+  distortion.reset();
 
-  auto *ch0 = buffer.getWritePointer(0);
-  auto *ch1 = (totalNumInputChannels > 1) ? buffer.getWritePointer(1) : nullptr;
+  if (!distDryHeld)
+    distDry = StereoFrame::load(channels, numChannels, 0);
+  distDryHeld = true;
+
+  // Only second order delays the dry signal whole
+  if (distortion.getOrder() != AdaaTanh::Order::Second) {
+    distDry = StereoFrame::load(channels, numChannels, numSamples - 1);
+    return;
+  }
 
   for (int i = 0; i < numSamples; ++i) {
-    float time = delayTimeParam.getNextValue();
-    float fdbk = delayFeedbackParam.getNextValue();
-    float mix = delayMixParam.getNextValue();
-
-    float delaySamples = time * (float)currentSampleRate;
-    delaySamples = juce::jlimit(1.0f, (float)(maxDelayTime * currentSampleRate),
-                                delaySamples);
-
-    delayLine.setDelay(delaySamples);
-
-    {
-      float input = ch0[i];
-      float delayed = delayLine.popSample(0, -1.0f);
-      float fbSignal = input + (delayed * fdbk);
-      delayLine.pushSample(0, fbSignal);
-      ch0[i] = input + (delayed * mix);
+    const auto dry = StereoFrame::load(channels, numChannels, i);
+    distDry.store(channels, numChannels, i);
+    distDry = dry;
+  }
+}
+
+void EffectsProcessor::resetDistortion() {
+  distortion.reset();
+  distDryHeld = false;
+}
+
+void EffectsProcessor::processBitcrusher(juce::AudioBuffer<float> &buffer) {
+  // Simple Bitcrush/Downsample
+  // Downsample factor: 4x (roughly 11kHz SR), in base-rate samples
+  // Bit depth: 8 bit via rounding
+  const float downsampleFactor = 4.0f * (float)oversampler.getFactor();
+  constexpr float levels = 256.0f;
+  const int numSamples = buffer.getNumSamples();
+  const int numChannels = juce::jmin(buffer.getNumChannels(), 2);
+  float *const *channels = buffer.getArrayOfWritePointers();
+
+  // Held in a local so it stays in a register across the stores
+  auto hold = crushHold;
+  for (int i = 0; i < numSamples; ++i) {
+    bitcrushPhase += 1.0f;
+    if (bitcrushPhase >= downsampleFactor) {
+      bitcrushPhase -= downsampleFactor;
+
+      // Quantize
+      const auto frame = StereoFrame::load(channels, numChannels, i);
+      hold = StereoFrame::round(frame * levels) * (1.0f / levels);
     }
+    hold.store(channels, numChannels, i);
+  }
+  crushHold = hold;
+}
+
+void EffectsProcessor::processDistortion(juce::AudioBuffer<float> &buffer) {
+  const int numChannels = juce::jmin(buffer.getNumChannels(), 2);
+  const int numSamples = buffer.getNumSamples();
+  float *const *channels = buffer.getArrayOfWritePointers();
 
-    if (ch1) {
-      float input = ch1[i];
-      float delayed = delayLine.popSample(1, -1.0f);
-      float fbSignal = input + (delayed * fdbk);
-      delayLine.pushSample(1, fbSignal);
-      ch1[i] = input + (delayed * mix);
+  const auto driveToGain = [hunt = huntEnabled](float drive) {
+    // Hunt Mode Logic ("Hunt" button essentially boosts Input Drive)
+    if (hunt)
+      drive = std::min(drive * 1.5f + 0.2f, 1.0f);
+    return 1.0f + (drive * 49.0f);
+  };
+
+  // A restarted shaper begins from a flat history; so does the dry
+  if (!distDryHeld)
+    distDry = StereoFrame::load(channels, numChannels, 0);
+  distDryHeld = true;
+
+  for (int start = 0; start < numSamples; start += ParameterRamp::maxLength) {
+    const int runLength =
+        juce::jmin(ParameterRamp::maxLength, numSamples - start);
+    const bool driveMoving = distDriveRamp.generate(distDriveParam, runLength);
+    const bool mixMoving = distMixRamp.generate(distMixParam, runLength);
+
+    if (driveMoving || mixMoving) {
+      float *gains = distDriveRamp.getRamp(runLength);
+      for (int i = 0; i < runLength; ++i)
+        gains[i] = driveToGain(gains[i]);
+      processDistortionRun<true>(channels, numChannels, start, runLength,
+                                 gains, distMixRamp.getRamp(runLength));
+    } else {
+      const float gain = driveToGain(distDriveRamp.getValue());
+      const float mix = distMixRamp.getValue();
+      processDistortionRun<false>(channels, numChannels, start, runLength,
+                                  &gain, &mix);
     }
   }
 }
 
-void EffectsProcessor::processReverb(juce::AudioBuffer<float> &buffer) {
-  // Use TargetValue because we are using block-based mixing via setParameters,
-  // so the Smoother isn't technically advanced per sample, but Target holds
-  // current setting.
-  if (reverbMixParam.getTargetValue() > 0.0f) {
-    juce::dsp::AudioBlock<float> block(buffer);
-    juce::dsp::ProcessContextReplacing<float> context(block);
-    reverb.process(context);
+template <bool ramping>
+void EffectsProcessor::processDistortionRun(float *const *channels,
+                                            int numChannels, int start,
+                                            int numSamples, const float *gains,
+                                            const float *mixes) {
+  StereoFrame gain = gains[0];
+  StereoFrame mix = mixes[0];
+
+  // The dry lined up with the shaper: the previous input for second order,
+  // halfway to it for first
+  const auto order = distortion.getOrder();
+  const StereoFrame lag = order == AdaaTanh::Order::Second  ? 1.0f
+                          : order == AdaaTanh::Order::First ? 0.5f
+                                                            : 0.0f;
+  auto previous = distDry;
+
+  for (int i = start; i < start + numSamples; ++i) {
+    if (ramping) {
+      gain = gains[i - start];
+      mix = mixes[i - start];
+    }
+
+    // Both channels go through the shaper together
+    const auto input = StereoFrame::load(channels, numChannels, i);
+    const auto wet = distortion.processFrame(input * gain, numChannels);
+    const auto dry = input + (previous - input) * lag;
+    previous = input;
+    (dry + (wet - dry) * mix).store(channels, numChannels, i);
   }
+  distDry = previous;
 }
@@ -1,104 +1,327 @@
 #pragma once
 
+#include "AdaaTanh.h"
+#include "ConvolutionReverb.h"
+#include "EffectGraph.h"
+#include "EffectsOversampler.h"
+#include "FdnReverb.h"
+#include "HalfBandResampler.h"
+#include "OutputAnalyser.h"
+#include "ParameterRamp.h"
+#include "RealtimeWorker.h"
+#include "ScratchArena.h"
+#include "StereoDelay.h"
+#include "StereoFrame.h"
 #include "TransientShaper.h"
 #include <JuceHeader.h>
 
 class EffectsProcessor {
 public:
-  enum class EffectType { Distortion, TransientShaper, Delay, Reverb };
+  using EffectType = EffectGraph::Node;
 
   EffectsProcessor();
   ~EffectsProcessor();
 
-  void prepare(juce::dsp::ProcessSpec &spec);
+  void prepare(juce::dsp::ProcessSpec &spec, ScratchArena &scratchArena);
   void process(juce::AudioBuffer<float> &buffer);
   void reset();
 
-  void setChainOrder(const std::array<EffectType, 4> &newOrder) {
-    chainOrder = newOrder;
-  }
-
-  const std::array<EffectType, 4> &getChainOrder() const { return chainOrder; }
+  // Message thread: queues a new layout. Switching nodes on or off fades
+  // just those nodes in or out. Anything that reorders the nodes or moves
+  // the audio in time crossfades the output to the dry input, swaps, and
+  // crossfades back. Nothing is allocated either side.
+  void setGraph(const EffectGraph &newGraph);
 
   void updateParameters(float distDrive, float distMix, float delayTime,
                         float delayFeedback, float delayMix, float reverbSize,
                         float reverbDecay, float reverbDamping, float reverbMix,
                         float biteAmount);
 
+  // Delay stereo image: width 0 = mono echoes, 1 = as is; ping-pong bounces
+  // the echoes between the sides
+  void setDelayStereo(float width, bool pingPong) {
+    delay.setStereo(width, pingPong);
+  }
+
+  // Distortion anti-aliasing: 0 = off, 1 = first-order ADAA, 2 = second.
+  // Second order adds a sample of latency, so switching fades like a graph
+  // change.
+  void setDistortionAntialiasing(int order) {
+    requestedDistortionOrder = (AdaaTanh::Order)juce::jlimit(0, 2, order);
+  }
+
+  // Oversampling of the distortion, bitcrusher and transient shaper:
+  // 0 = 1x (off), 1 = 2x, 2 = 4x, 3 = 8x. Switching fades like a graph
+  // change.
+  void setOversampling(int factorIndex) {
+    requestedOversampling = juce::jlimit(0, 3, factorIndex);
+  }
+
+  // Latency along the active path. The oversampling filters add theirs
+  // whenever an unbypassed nonlinear node is wrapped, and the transient
+  // shaper its lookahead whenever it is unbypassed, however much either is
+  // doing. So does second-order distortion anti-aliasing at 1x.
+  int getLatencySamples() const {
+    const bool shaperDelays =
+        shaperLookahead && graph.isActive(EffectType::TransientShaper);
+    return oversampler.getLatencySamples() +
+           (shaperDelays ? shaperLookaheadSamples : 0) +
+           getDistortionLatency(graph);
+  }
+
+  // Transient shaper: stereo-linked detection, and a 2 ms lookahead that
+  // adds to the latency. Switching the lookahead fades like a graph change.
+  void setTransientShaperMode(bool stereoLink, bool lookahead) {
+    transientShaper.setStereoLink(stereoLink);
+    requestedShaperLookahead = lookahead;
+  }
+
+  // Rate of the delay and FDN reverb wet signals: 0 = full, 1 = 1/2, 2 = 1/4.
+  // The dry path stays at the full rate and the wet keeps everything below
+  // 0.2x (1/2) or 0.1x (1/4) the host rate. Switching fades the output like
+  // a graph change and drops the delay and reverb tails.
+  void setWetPathRate(int rateIndex) {
+    requestedWetFactor = 1 << juce::jlimit(0, 2, rateIndex);
+  }
+
+  // Message thread: lets a helper thread render one branch of a parallel
+  // split (the delay and reverb sends) while the audio thread renders the
+  // other. The thread only runs while the graph has such a split.
+  void setHelperThreadEnabled(bool enabled);
+
+  // 0 = Eco (8 static lines), 1 = Standard (8 modulated), 2 = High (16)
+  void setReverbQuality(int tier) {
+    reverb.setQuality((FdnReverb::Quality)juce::jlimit(0, 2, tier));
+  }
+
+  // Convolution stage after the FDN: mix 0..1, space is a built-in cave
+  // (0 = Cave, 1 = Deep Cave, 2 = Abyss)
+  void setConvolution(float mix, int space);
+
+  // Swaps a user IR in for the built-in cave; decoded in the background
+  void loadConvolutionImpulse(const juce::File &file) {
+    convolution.loadImpulseResponse(file);
+  }
+
+  // True once every effect's input and internal state are silent, so a
+  // silent block passes through untouched
+  bool isIdle() const;
+
+  // Worst-case ring-out of the delay and reverbs for the current settings
+  double getTailLengthSeconds() const {
+    return tailLengthSeconds.load() + convolutionTailSeconds.load();
+  }
+
 private:
-  // Helper for smoothing
-  void generateRamp(juce::LinearSmoothedValue<float> &smoother, int numSamples);
-  std::vector<float> rampBuffer;
+  // About -120 dBFS: anything quieter counts as silence
+  static constexpr float silenceThreshold = 1.0e-6f;
+  std::atomic<double> tailLengthSeconds{0.0};
+  std::atomic<double> convolutionTailSeconds{0.0};
+
+  // Moves the smoothers on as if a block had been processed
+  void skipSmoothers(int numSamples);
+
+  // --- Graph ---
+  // Triple-buffered handover: the message thread writes its own slot and
+  // swaps it into the shared one; the audio thread swaps the shared slot
+  // with its own when the fresh flag is set
+  static constexpr int freshGraph = 4;
+  static constexpr int graphSlotMask = 3;
+  std::array<EffectGraph, 3> graphSlots;
+  int writerSlot = 0;
+  int readerSlot = 1;
+  std::atomic<int> sharedSlot{2};
+
+  EffectGraph graph;       // Audio thread's working copy
+  EffectGraph targetGraph; // Latest layout, which graph is moving towards
+  bool graphSwapPending = false;
+  ScratchArena *scratch = nullptr; // Parallel branch buffers
+
+  // A swap crossfades the effects' output with the dry input, delayed by
+  // the latency so the two line up
+  juce::LinearSmoothedValue<float> graphFade; // 1 = all effects output
+  juce::AudioBuffer<float> dryLine, dryBuffer;
+  int dryLineMask = 0, dryLinePos = 0;
+  void delayDry(const juce::AudioBuffer<float> &buffer, bool readBack);
+
+  // A node being switched on or off keeps running while its change to the
+  // signal fades in or out, and is only bypassed once that reaches zero.
+  // Its input is kept in nodeFadeInput meanwhile (one node at a time, so
+  // parallel branches stay on the audio thread during a fade).
+  std::array<juce::LinearSmoothedValue<float>, EffectGraph::numNodeTypes>
+      nodeFades;
+  std::array<float, EffectGraph::numNodeTypes> nodeFadeStart{}, nodeFadeEnd{};
+  juce::AudioBuffer<float> nodeFadeInput; // Up to a block at 8x
+  bool anyNodeFading = false;
+  bool isNodeFading(EffectType node) const {
+    return nodeFadeEnd[(size_t)node] < 1.0f ||
+           nodeFadeStart[(size_t)node] < 1.0f;
+  }
+  void updateNodeFades(bool idle, int numSamples);
+  bool beginNodeFade(EffectType node, const juce::AudioBuffer<float> &buffer);
+  void endNodeFade(EffectType node, juce::AudioBuffer<float> &buffer);
+  void processNode(EffectType node, juce::AudioBuffer<float> &buffer,
+                   bool &silent);
+
+  void updateGraph(bool idle, int numSamples);
+  bool needsGraphSwap() const;
+  void adoptTargetGraph();
+  void resetNode(EffectType node);
+  void processStage(const EffectGraph::Stage &stage,
+                    juce::AudioBuffer<float> &buffer, bool &silent);
+  void processBranch(const EffectGraph::Branch &branch,
+                     juce::AudioBuffer<float> &buffer, bool &silent);
+  void processChain(const EffectType *nodes, int numNodes,
+                    juce::AudioBuffer<float> &buffer, bool &silent);
+  bool hasActiveNode(const EffectGraph::Branch &branch) const;
+
+  // One branch of a parallel stage, run on the helper thread
+  struct BranchJob : RealtimeWorker::Job {
+    void run() override { owner->processBranch(*branch, buffer, silent); }
+
+    EffectsProcessor *owner = nullptr;
+    const EffectGraph::Branch *branch = nullptr;
+    juce::AudioBuffer<float> buffer; // Refers to arena memory
+    bool silent = false;
+  };
+
+  BranchJob branchJob;
+  RealtimeWorker helper; // Stopped before the job goes
+
+  // The helper runs while it is enabled and the latest graph has a split
+  // with work on both sides. Started and stopped off the audio thread.
+  static bool hasParallelWork(const EffectGraph &layout);
+  void updateHelperThread();
+  juce::CriticalSection helperLock;
+  bool helperThreadEnabled = true, helperNeeded = false;
+  double helperPeriodMs = 0.0; // Zero until prepared
+
+  // --- Oversampling ---
+  // The active nonlinear nodes run back to back inside one oversampler. That
+  // needs them in consecutive serial stages, which every chain preset keeps
+  // them; any other layout falls back to 1x.
+  static bool isNonlinear(EffectType effect) {
+    return effect == EffectType::Distortion ||
+           effect == EffectType::Bitcrusher ||
+           effect == EffectType::TransientShaper;
+  }
+  // Stages [first, last) that go through the oversampler, or -1 for none
+  static void findOversampledStages(const EffectGraph &layout, int &first,
+                                    int &last);
+  int getOversamplingFactorIndex(const EffectGraph &layout) const;
+  void updateOversamplingFactor();
+  void updateStageRates(); // Re-times the stages for the oversampled rate
+  bool areNonlinearStagesActive() const;
+  void processOversampled(juce::AudioBuffer<float> &buffer, int firstStage,
+                          int lastStage, bool &silent);
+
+  EffectsOversampler oversampler;
+  int oversampling = 0, requestedOversampling = 0; // Factor index
+  int oversampledFirst = -1, oversampledLast = -1; // Stage range, or none
+  juce::dsp::ProcessSpec preparedSpec{44100.0, 512, 2};
+
+  // --- Reduced-rate wet path ---
+  // A run of active delay and reverb nodes with nothing else between them
+  // (serial stages, or within one branch) shares one trip down to the
+  // reduced rate and back. Linear nodes keep the run's output in the form
+  // dry gain x input + wet, so only the wet goes through the filters and
+  // the dry never picks up their phase. The convolution reverb stays at the
+  // full rate after the run; being linear, it commutes with the delay.
+  static bool isWetNode(EffectType effect) {
+    return effect == EffectType::Delay || effect == EffectType::Reverb;
+  }
+  void updateWetPathRate();
+  void processReducedRate(const EffectType *run, int runLength,
+                          juce::AudioBuffer<float> &buffer, bool &silent);
+
+  // One per node that can lead a run (the delay's, then the reverb's), so
+  // the two sends of a parallel split can render on different threads
+  struct WetPath {
+    HalfBandResampler resampler;
+    juce::AudioBuffer<float> input, wet, work; // Low-rate, sized in prepare
+  };
+  std::array<WetPath, 2> wetPaths;
+
+  // Takes up to a prepared block through the run at the low rate. Returns
+  // whether the run added any wet signal.
+  bool processWetPath(const EffectType *run, int runLength, WetPath &path,
+                      juce::AudioBuffer<float> &buffer, bool silent);
+  int wetFactor = 1, requestedWetFactor = 1;
 
   // --- Distortion ---
-  // Use Waveshaper for standard tanh distortion (Josh Hodge style)
+  // tanh drive with antiderivative anti-aliasing. The wet lags by the
+  // shaper's half or one sample at the stage rate, and the dry is lined up
+  // with it so the mix doesn't comb: delayed a whole sample for second
+  // order (which holds at a mix of zero too, so the latency stays put), or
+  // averaged with the previous sample for first order.
   juce::LinearSmoothedValue<float> distDriveParam;
   juce::LinearSmoothedValue<float> distMixParam;
-  juce::dsp::WaveShaper<float> distortion;
+  ParameterRamp distDriveRamp, distMixRamp;
+  AdaaTanh distortion;
+  AdaaTanh::Order requestedDistortionOrder = AdaaTanh::Order::Second;
+  StereoFrame distDry;       // Previous input, for the aligned dry
+  bool distDryHeld = false;  // Else distDry starts flat at the next input
+  bool isDistorting() const; // False while the mix rests at zero
+  void skipDistortion(int numSamples); // Silent: state goes to rest
+  void holdDistortion(juce::AudioBuffer<float> &buffer); // Dry: just delays
+  void resetDistortion();
+  // The second-order lag is a whole host sample at 1x; oversampled it is a
+  // fraction of one, which can't be reported and goes uncompensated
+  int getDistortionLatency(const EffectGraph &layout) const {
+    return layout.isActive(EffectType::Distortion) &&
+                   distortion.getOrder() == AdaaTanh::Order::Second &&
+                   getOversamplingFactorIndex(layout) == 0
+               ? 1
+               : 0;
+  }
 
   // --- Transient Shaper ---
   TransientShaper transientShaper;
+  static constexpr double shaperLookaheadSeconds = 0.002;
+  int shaperLookaheadSamples = 0; // At the host rate
+  bool shaperLookahead = false, requestedShaperLookahead = false;
+  void updateShaperLookahead();
 
   // --- Delay ---
-  juce::LinearSmoothedValue<float> delayTimeParam;
-  juce::LinearSmoothedValue<float> delayFeedbackParam;
-  juce::LinearSmoothedValue<float> delayMixParam;
-
-  // Choose Lagrange for better pitch shifting/modulation support, or Linear for
-  // efficiency. Using Linear for standard echo.
-  juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::Linear>
-      delayLine;
-  static constexpr float maxDelayTime = 2.0f;
-  std::vector<float>
-      delayFeedbackBuffer; // To store feedback values per channel
+  StereoDelay delay;
 
   // --- Reverb ---
-  juce::dsp::Reverb reverb;
-  juce::dsp::Reverb::Parameters reverbParams;
-  juce::LinearSmoothedValue<float> reverbMixParam;
+  FdnReverb reverb;
+  ConvolutionReverb convolution;
 
   double currentSampleRate = 44100.0;
 
   // Helper for Dry/Wet mixing
   // We'll do simple linear mix implementation inline for clarity
 
+  // One graph node; silent says whether the block is known to be silent
+  void processEffect(EffectType effect, juce::AudioBuffer<float> &buffer,
+                     bool &silent);
   void processDistortion(juce::AudioBuffer<float> &buffer);
-  void processTransientShaper(juce::AudioBuffer<float> &buffer);
-  void processDelay(juce::AudioBuffer<float> &buffer);
-  void processReverb(juce::AudioBuffer<float> &buffer);
-
-  std::array<EffectType, 4> chainOrder = {
-      EffectType::Distortion, EffectType::TransientShaper, EffectType::Delay,
-      EffectType::Reverb};
+  // One run with drive gain and mix either held (gains[0], mixes[0]) or
+  // ramping (one per sample)
+  template <bool ramping>
+  void processDistortionRun(float *const *channels, int numChannels,
+                            int start, int numSamples, const float *gains,
+                            const float *mixes);
 
   // --- Metering ---
 public:
-  // Public for easy access by Editor
-  std::atomic<float> eqLow{0.0f}, eqMid{0.0f}, eqHigh{0.0f};
+  // Output tap for the Effects tab meters; analysed on the UI thread
+  OutputAnalyser &getAnalyser() { return analyser; }
 
   // --- New Effects ---
   void setHuntEnabled(bool enabled) { huntEnabled = enabled; }
-  void setBitcrushEnabled(bool enabled) { bitcrushEnabled = enabled; }
 
 private:
   bool huntEnabled = false;
-  bool bitcrushEnabled = false;
-
-  // Analysis Filters for Metering
-  juce::dsp::StateVariableTPTFilter<float> meterFilterLow;
-  juce::dsp::StateVariableTPTFilter<float> meterFilterMid;
-  juce::dsp::StateVariableTPTFilter<float> meterFilterHigh;
 
-  // Scratch buffers (avoid allocating on audio thread)
-  juce::AudioBuffer<float> meterScratchLow;
-  juce::AudioBuffer<float> meterScratchMid;
-  juce::AudioBuffer<float> meterScratchHigh;
+  OutputAnalyser analyser;
 
   // Bitcrusher
   float bitcrushPhase = 0.0f;
-  float lastCrushedSampleL = 0.0f;
-  float lastCrushedSampleR = 0.0f;
+  StereoFrame crushHold; // Last quantised frame
 
   void processBitcrusher(juce::AudioBuffer<float> &buffer);
-  void processMetering(const juce::AudioBuffer<float> &buffer);
+  bool isBitcrusherHolding() const; // Still outputting a non-zero hold
 };
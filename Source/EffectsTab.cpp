@@ -68,7 +68,10 @@ EffectsTab::EffectsTab(HowlingWolvesAudioProcessor &p) : audioProcessor(p) {
 
 EffectsTab::~EffectsTab() { stopTimer(); }
 
-void EffectsTab::timerCallback() { repaint(); }
+void EffectsTab::timerCallback() {
+  audioProcessor.updateMetering();
+  repaint();
+}
 
 void EffectsTab::setupSlider(
     juce::Slider &s, const juce::String &paramId,
@@ -140,6 +143,22 @@ void EffectsTab::drawEQBars(juce::Graphics &g) {
 
   float values[] = {lo, mid, hi};
 
+  // Output spectrum, faintly behind the bars
+  const auto &spectrum = audioProcessor.getSpectrum();
+  auto specArea = barsArea.withTrimmedBottom(20).toFloat();
+  juce::Path spectrumPath;
+  spectrumPath.startNewSubPath(specArea.getBottomLeft());
+  for (size_t i = 0; i < spectrum.size(); ++i) {
+    float x = specArea.getX() +
+              specArea.getWidth() * (float)i / (float)(spectrum.size() - 1);
+    spectrumPath.lineTo(x, specArea.getBottom() -
+                               specArea.getHeight() * spectrum[i]);
+  }
+  spectrumPath.lineTo(specArea.getBottomRight());
+  spectrumPath.closeSubPath();
+  g.setColour(juce::Colours::cyan.withAlpha(0.15f));
+  g.fillPath(spectrumPath);
+
   for (int i = 0; i < 3; ++i) {
     auto col = barsArea.removeFromLeft((int)barW).reduced(10, 0);
     auto bar = col.removeFromTop(col.getHeight() - 20);
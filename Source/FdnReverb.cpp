@@ -0,0 +1,299 @@
+#include "FdnReverb.h"
+
+namespace {
+// Line lengths in ms at size 1. Spread out and mutually detuned so the modes
+// don't pile up; the 8-line tiers use every other entry.
+constexpr double baseLengthsMs[FdnReverb::maxLines] = {
+    31.7, 35.3, 37.9, 41.3, 43.9, 47.9, 53.3, 57.1,
+    61.7, 66.1, 71.9, 76.3, 83.9, 89.1, 97.3, 103.9};
+
+// In-place normalised fast Walsh-Hadamard transform
+template <int N> void hadamard(float *x) {
+  for (int h = 1; h < N; h *= 2) {
+    for (int i = 0; i < N; i += 2 * h) {
+      for (int j = i; j < i + h; ++j) {
+        const float a = x[j];
+        const float b = x[j + h];
+        x[j] = a + b;
+        x[j + h] = a - b;
+      }
+    }
+  }
+
+  const float scale = 1.0f / std::sqrt((float)N);
+  for (int j = 0; j < N; ++j)
+    x[j] *= scale;
+}
+} // namespace
+
+void FdnReverb::prepare(const juce::dsp::ProcessSpec &spec) {
+  preparedRate = spec.sampleRate;
+
+  // Sized for the full rate, whatever the divisor
+  const double longestMs = baseLengthsMs[maxLines - 1] * maxSizeScale;
+  const int longest =
+      (int)std::ceil(longestMs * 0.001 * preparedRate +
+                     2.0 * modDepthSeconds * preparedRate) + 4;
+  lineStride = juce::nextPowerOfTwo(longest);
+  lineMask = lineStride - 1;
+  lineMemory.assign((size_t)(lineStride * maxLines), 0.0f);
+
+  updateRate();
+}
+
+void FdnReverb::setRateDivisor(int divisor) {
+  divisor = juce::jlimit(1, 4, divisor);
+  if (divisor == rateDivisor)
+    return;
+
+  rateDivisor = divisor;
+  updateRate();
+}
+
+void FdnReverb::updateRate() {
+  sampleRate = preparedRate / rateDivisor;
+  modDepthSamples = (float)(modDepthSeconds * sampleRate);
+
+  // Slow, unrelated rates and spread-out phases for the read modulation
+  for (int l = 0; l < maxLines; ++l) {
+    const double rateHz = 0.13 + 0.071 * l;
+    const double step =
+        juce::MathConstants<double>::twoPi * rateHz / sampleRate;
+    const double phase = 2.399963 * l; // Golden angle
+    modSin[l] = (float)std::sin(phase);
+    modCos[l] = (float)std::cos(phase);
+    modRotSin[l] = (float)std::sin(step);
+    modRotCos[l] = (float)std::cos(step);
+  }
+
+  mixParam.reset(sampleRate, 0.05);
+  updateLineSettings();
+  reset();
+}
+
+void FdnReverb::reset() {
+  std::fill(lineMemory.begin(), lineMemory.end(), 0.0f);
+  std::fill(std::begin(dampState), std::end(dampState), 0.0f);
+  std::copy(std::begin(lineDelay), std::end(lineDelay),
+            std::begin(currentDelay));
+  writePos = 0;
+  idle = true;
+  quietSamples = 0;
+}
+
+void FdnReverb::setParameters(float size, float decay, float damping,
+                              float mix) {
+  sizeParam = juce::jlimit(0.0f, 1.0f, size);
+  rt60Seconds = 0.2 * std::pow(60.0, (double)juce::jlimit(0.0f, 1.0f, decay));
+  dampCoeff = juce::jlimit(0.0f, 1.0f, damping) * 0.85f;
+  mixParam.setTargetValue(juce::jlimit(0.0f, 1.0f, mix));
+  updateLineSettings();
+}
+
+void FdnReverb::setQuality(Quality newQuality) {
+  if (newQuality == quality)
+    return;
+
+  quality = newQuality;
+  activeLines = quality == Quality::High ? 16 : 8;
+  modulated = quality != Quality::Eco;
+  updateLineSettings();
+  reset(); // The line layout changed, so start the tail afresh
+}
+
+void FdnReverb::updateLineSettings() {
+  const double scale = 0.25 + (maxSizeScale - 0.25) * sizeParam;
+  const int spacing = maxLines / activeLines;
+
+  // A pole at p per prepared-rate sample is one at p^d per d samples
+  dampPole = rateDivisor > 1 ? std::pow(dampCoeff, (float)rateDivisor)
+                             : dampCoeff;
+
+  for (int l = 0; l < activeLines; ++l) {
+    double length = baseLengthsMs[l * spacing] * 0.001 * scale * sampleRate;
+    if (!modulated)
+      length = std::round(length); // Static taps read whole samples
+    lineDelay[l] = (float)length;
+    // Loses 60 dB over rt60Seconds no matter how long the line is
+    lineGain[l] =
+        (float)std::pow(10.0, -3.0 * length / (rt60Seconds * sampleRate));
+  }
+}
+
+bool FdnReverb::process(juce::AudioBuffer<float> &buffer, bool inputSilent) {
+  const int numSamples = buffer.getNumSamples();
+  if (numSamples <= 0 || buffer.getNumChannels() <= 0 || lineMemory.empty())
+    return false;
+
+  if (mixParam.getTargetValue() <= 0.0f && !mixParam.isSmoothing()) {
+    if (!idle)
+      reset(); // Don't resume a stale tail when the mix comes back
+    return false;
+  }
+
+  if (inputSilent && idle) {
+    mixParam.skip(numSamples);
+    return false;
+  }
+
+  float *left = buffer.getWritePointer(0);
+  float *right = buffer.getNumChannels() > 1 ? buffer.getWritePointer(1)
+                                             : nullptr;
+
+  // The network costs far more per sample than reading the mix from a
+  // ramp, so a held mix is just filled in rather than given its own kernel
+  // Static taps that have settled on their (whole-sample) lengths are read
+  // without interpolation or slewing
+  bool settled = !modulated;
+  for (int l = 0; l < activeLines; ++l) {
+    if (std::abs(currentDelay[l] - lineDelay[l]) < 1.0e-3f)
+      currentDelay[l] = lineDelay[l];
+    else
+      settled = false;
+  }
+
+  float peak = 0.0f;
+  for (int start = 0; start < numSamples; start += ParameterRamp::maxLength) {
+    const int runLength =
+        juce::jmin(ParameterRamp::maxLength, numSamples - start);
+    mixRamp.generate(mixParam, runLength);
+    const float *mixes = mixRamp.getRamp(runLength);
+    float *runRight = right != nullptr ? right + start : nullptr;
+    float runPeak;
+    if (activeLines == 16)
+      runPeak = processLines<16, true>(left + start, runRight, runLength,
+                                       mixes);
+    else if (settled)
+      runPeak = processLines<8, false>(left + start, runRight, runLength,
+                                       mixes);
+    else
+      runPeak = processLines<8, true>(left + start, runRight, runLength,
+                                      mixes);
+    peak = juce::jmax(peak, runPeak);
+  }
+
+  // Keep the modulation oscillators on the unit circle
+  for (int l = 0; l < activeLines; ++l) {
+    const float norm =
+        1.0f / std::sqrt(modSin[l] * modSin[l] + modCos[l] * modCos[l]);
+    modSin[l] *= norm;
+    modCos[l] *= norm;
+  }
+
+  // Quiet writes for longer than the longest line: the network has run dry
+  if (peak >= silenceThreshold) {
+    idle = false;
+    quietSamples = 0;
+  } else {
+    quietSamples += numSamples;
+    const float longest =
+        *std::max_element(currentDelay, currentDelay + activeLines) +
+        2.0f * modDepthSamples;
+    if ((float)quietSamples > longest)
+      reset();
+  }
+
+  return true;
+}
+
+template <int numLines, bool interpolated>
+float FdnReverb::processLines(float *left, float *right, int numSamples,
+                              const float *mixes) {
+  // Each input feeds half the lines and each output sums half of them. The
+  // per-line energy falls as 1/N while the sum has N/2 terms, so one fixed
+  // output gain keeps the 8- and 16-line tiers equally loud.
+  const float inputGain = 1.0f / std::sqrt((float)numLines);
+  constexpr float outputGain = 0.7071f;
+  constexpr float maxSlew = 0.05f; // Samples per sample while resizing
+
+  alignas(64) float taps[numLines];
+  alignas(64) float feedback[numLines];
+  alignas(64) int wholeDelay[numLines];
+  float *const memory = lineMemory.data();
+  float peak = 0.0f;
+
+  if (!interpolated)
+    for (int l = 0; l < numLines; ++l)
+      wholeDelay[l] = (int)currentDelay[l];
+
+  for (int i = 0; i < numSamples; ++i) {
+    const float inL = left[i];
+    const float inR = right != nullptr ? right[i] : inL;
+
+    for (int l = 0; l < numLines; ++l) {
+      if (!interpolated) {
+        const int index = (writePos - wholeDelay[l]) & lineMask;
+        taps[l] = memory[l * lineStride + index];
+        continue;
+      }
+
+      float delay = currentDelay[l];
+      if (modulated)
+        delay += modDepthSamples * (1.0f + modSin[l]);
+
+      const float readPos = (float)writePos - delay;
+      const float whole = std::floor(readPos);
+      const float frac = readPos - whole;
+      const int index = (int)whole;
+      const float *line = memory + l * lineStride;
+      const float a = line[index & lineMask];
+      const float b = line[(index + 1) & lineMask];
+      taps[l] = a + (b - a) * frac;
+    }
+
+    float wetL = 0.0f, wetR = 0.0f;
+    for (int l = 0; l < numLines; l += 2) {
+      wetL += taps[l];
+      wetR += taps[l + 1];
+    }
+
+    // Damping and decay, then the lossless mix
+    for (int l = 0; l < numLines; ++l) {
+      dampState[l] = taps[l] + dampPole * (dampState[l] - taps[l]);
+      feedback[l] = dampState[l] * lineGain[l];
+    }
+    hadamard<numLines>(feedback);
+
+    for (int l = 0; l < numLines; ++l) {
+      const float x = feedback[l] + ((l & 1) ? inR : inL) * inputGain;
+      memory[l * lineStride + writePos] = x;
+      peak = juce::jmax(peak, std::abs(x));
+    }
+    writePos = (writePos + 1) & lineMask;
+
+    if (interpolated && modulated) {
+      for (int l = 0; l < numLines; ++l) {
+        const float s = modSin[l];
+        const float c = modCos[l];
+        modSin[l] = s * modRotCos[l] + c * modRotSin[l];
+        modCos[l] = c * modRotCos[l] - s * modRotSin[l];
+      }
+    }
+
+    // Size changes glide instead of jumping the read heads
+    if (interpolated)
+      for (int l = 0; l < numLines; ++l)
+        currentDelay[l] += juce::jlimit(-maxSlew, maxSlew,
+                                        lineDelay[l] - currentDelay[l]);
+
+    const float mix = mixes[i];
+    wetL *= outputGain;
+    wetR *= outputGain;
+
+    if (wetOnly) {
+      if (right != nullptr) {
+        left[i] = wetL * mix;
+        right[i] = wetR * mix;
+      } else {
+        left[i] = 0.5f * (wetL + wetR) * mix;
+      }
+    } else if (right != nullptr) {
+      left[i] = inL + (wetL - inL) * mix;
+      right[i] = inR + (wetR - inR) * mix;
+    } else {
+      left[i] = inL + (0.5f * (wetL + wetR) - inL) * mix;
+    }
+  }
+
+  return peak;
+}
@@ -31,59 +31,103 @@ void FilterProcessor::prepare(const juce::dsp::ProcessSpec &spec) {
   filter.prepare(spec);
   filter.reset();
 
-  // Prepare formant bands
-  for (auto &band : formantBands) {
-    band.filter.prepare(spec);
-    band.filter.reset();
-  }
+  // Formant glides land on the control grid, so a few intervals is plenty
+  vowelPosition.reset(spec.sampleRate, 0.02);
+  formantQ.reset(spec.sampleRate, 0.02);
+  vowelPosition.setCurrentAndTargetValue(vowelPosition.getTargetValue());
+  formantQ.setCurrentAndTargetValue(formantQ.getTargetValue());
+  updateFormantCoefficients();
+  reset();
 }
 
 void FilterProcessor::process(juce::AudioBuffer<float> &buffer) {
-  if (currentType == Formant) {
-    // Parallel implementation
-    auto numSamples = buffer.getNumSamples();
-    auto numChannels = buffer.getNumChannels();
-
-    // We need a scratch buffer to sum into, because we can't process in-place
-    // effectively in parallel logic without copying the input first. Easiest:
-    // Copy input to scratch, clear output, add formatted bands to output.
-
-    juce::AudioBuffer<float> scratchBuffer;
-    scratchBuffer.makeCopyOf(buffer);
-    buffer.clear();
-
-    for (int i = 0; i < 5; ++i) {
-      // Create a temp copy for this band processing
-      juce::AudioBuffer<float> bandBuffer;
-      bandBuffer.makeCopyOf(scratchBuffer);
-
-      juce::dsp::AudioBlock<float> block(bandBuffer);
-      juce::dsp::ProcessContextReplacing<float> context(block);
-      formantBands[i].filter.process(context);
-
-      // Apply Gain
-      bandBuffer.applyGain(formantBands[i].targetGain);
-
-      // Sum into main buffer
-      for (int ch = 0; ch < numChannels; ++ch) {
-        buffer.addFrom(ch, 0, bandBuffer, ch, 0, numSamples);
-      }
-    }
-
-  } else {
+  if (currentType != Formant) {
     juce::dsp::AudioBlock<float> block(buffer);
     juce::dsp::ProcessContextReplacing<float> context(block);
     filter.process(context);
+    return;
+  }
+
+  // All bands run in one pass over the buffer, in place
+  const int numSamples = buffer.getNumSamples();
+  const int numChannels = juce::jmin(buffer.getNumChannels(), maxChannels);
+
+  for (int start = 0; start < numSamples; start += controlInterval) {
+    const int runLength = juce::jmin(controlInterval, numSamples - start);
+
+    if (vowelPosition.isSmoothing() || formantQ.isSmoothing()) {
+      vowelPosition.skip(runLength);
+      formantQ.skip(runLength);
+      formantCoefficientsDirty = true;
+    }
+    if (formantCoefficientsDirty)
+      updateFormantCoefficients();
+
+    for (int ch = 0; ch < numChannels; ++ch)
+      processFormants(buffer.getWritePointer(ch) + start, runLength,
+                      formantState[(size_t)ch]);
+  }
+}
+
+void FilterProcessor::processFormants(float *samples, int numSamples,
+                                      FormantState &state) {
+  // Local copies stay in registers; the audio stores could alias members
+  alignas(32) float b0[numLanes], a1[numLanes], a2[numLanes];
+  alignas(32) float s1[numLanes], s2[numLanes];
+  for (int l = 0; l < numLanes; ++l) {
+    b0[l] = formantB0[l];
+    a1[l] = formantA1[l];
+    a2[l] = formantA2[l];
+    s1[l] = state.s1[l];
+    s2[l] = state.s2[l];
+  }
+
+  for (int i = 0; i < numSamples; ++i) {
+    const float x = samples[i];
+
+    alignas(32) float y[numLanes];
+    for (int l = 0; l < numLanes; ++l) {
+      y[l] = b0[l] * x + s1[l];
+      s1[l] = s2[l] - a1[l] * y[l];
+      s2[l] = -b0[l] * x - a2[l] * y[l];
+    }
+
+    float sum = 0.0f;
+    for (int l = 0; l < numLanes; ++l)
+      sum += y[l];
+    samples[i] = sum;
+  }
+
+  for (int l = 0; l < numLanes; ++l) {
+    state.s1[l] = s1[l];
+    state.s2[l] = s2[l];
   }
 }
 
 void FilterProcessor::reset() {
   filter.reset();
-  for (auto &band : formantBands)
-    band.filter.reset();
+  formantState = {};
+}
+
+bool FilterProcessor::isFormantIdle() const {
+  // About -120 dBFS, as the effects' silence threshold
+  constexpr float silenceThreshold = 1.0e-6f;
+  for (const auto &state : formantState)
+    for (int l = 0; l < numLanes; ++l)
+      if (std::abs(state.s1[l]) >= silenceThreshold ||
+          std::abs(state.s2[l]) >= silenceThreshold)
+        return false;
+  return true;
 }
 
 void FilterProcessor::setFilterType(FilterType type) {
+  if (type == currentType)
+    return;
+
+  // The bank has been idle (or never ran): start it from rest
+  if (type == Formant)
+    formantState = {};
+
   currentType = type;
 
   switch (type) {
@@ -100,7 +144,6 @@ void FilterProcessor::setFilterType(FilterType type) {
     filter.setType(juce::dsp::StateVariableTPTFilterType::bandpass);
     break;
   case Formant:
-    updateFormantCoefficients();
     break;
   }
 }
@@ -113,44 +156,43 @@ void FilterProcessor::setResonance(float resonance) {
   float q = 0.5f + resonance * 9.5f;
   filter.setResonance(q);
 
-  // Also update formant Q if we want global Q control
-  // For formants, usually Q is fixed or high, but let's allow "singing" vs
-  // "mumbling"
-  for (auto &band : formantBands) {
-    band.targetQ = q * 2.0f; // Formants usually fairly resonant
-  }
-  updateFormantCoefficients();
+  // Formants share the resonance control; they sit at twice the Q, since
+  // vowels need fairly sharp peaks. The coefficients follow at control rate.
+  formantQ.setTargetValue(q * 2.0f);
 }
 
 void FilterProcessor::setVowel(float vowelPos) {
-  if (std::abs(vowelPosition - vowelPos) > 0.001f) {
-    vowelPosition =
-        juce::jlimit(0.0f, 4.0f, vowelPos * 4.0f); // Map 0-1 to 0-4 range
-    updateFormantCoefficients();
-  }
+  // Map 0-1 to 0-4 range
+  vowelPosition.setTargetValue(juce::jlimit(0.0f, 4.0f, vowelPos * 4.0f));
 }
 
 void FilterProcessor::updateFormantCoefficients() {
   // Interpolate between vowels
   // 0 = A, 1 = E, 2 = I, 3 = O, 4 = U
+  const float position = vowelPosition.getCurrentValue();
+  const float q = formantQ.getCurrentValue();
 
-  int index1 = (int)vowelPosition;
+  int index1 = (int)position;
   int index2 = std::min(index1 + 1, 4);
-  float alpha = vowelPosition - (float)index1;
+  float alpha = position - (float)index1;
 
-  for (int i = 0; i < 5; ++i) {
+  for (int i = 0; i < numFormants; ++i) {
     float f1 = formantFreqs[index1][i];
     float f2 = formantFreqs[index2][i];
-    float freq = f1 + (f2 - f1) * alpha;
+    float freq = juce::jmin(f1 + (f2 - f1) * alpha, sampleRate * 0.45f);
 
     float g1 = formantGains[index1][i];
     float g2 = formantGains[index2][i];
     float gain = g1 + (g2 - g1) * alpha;
 
-    // Update filters
-    formantBands[i].filter.coefficients =
-        juce::dsp::IIR::Coefficients<float>::makeBandPass(
-            sampleRate, freq, formantBands[i].targetQ);
-    formantBands[i].targetGain = gain;
+    // RBJ band-pass, as IIR::Coefficients::makeBandPass
+    const float w = juce::MathConstants<float>::twoPi * freq / sampleRate;
+    const float bandwidth = std::sin(w) / (2.0f * q);
+    const float a0Inverse = 1.0f / (1.0f + bandwidth);
+    formantB0[i] = gain * bandwidth * a0Inverse;
+    formantA1[i] = -2.0f * std::cos(w) * a0Inverse;
+    formantA2[i] = (1.0f - bandwidth) * a0Inverse;
   }
+
+  formantCoefficientsDirty = false;
 }
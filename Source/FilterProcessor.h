@@ -11,24 +11,45 @@ public:
   void process(juce::AudioBuffer<float> &buffer);
   void reset();
 
+  // True once the formant bank has rung out, so silence can skip it
+  bool isFormantIdle() const;
+
   void setFilterType(FilterType type);
   void setCutoff(float cutoffHz);
   void setResonance(float resonance);
   void setVowel(float vowelPos); // 0.0 (A) to 1.0 (U)
 
 private:
-  struct FormantBand {
-    juce::dsp::IIR::Filter<float> filter;
-    float targetFreq = 1000.0f;
-    float targetQ = 1.0f;
-    float targetGain = 1.0f;
+  // The formant bank: five band-passes in parallel, one per SIMD lane and
+  // padded to eight so a pass over the lanes is two SSE / one AVX op with
+  // no remainder. The padding lanes have zero coefficients and stay silent.
+  static constexpr int numFormants = 5;
+  static constexpr int numLanes = 8;
+  static constexpr int maxChannels = 2;
+
+  // Vowel and Q glide at the input rate but the coefficients are only
+  // recomputed every controlInterval samples
+  static constexpr int controlInterval = 32;
+
+  // Transposed direct form II band-pass with constant 0 dB peak, the band
+  // gain folded into b0 (b1 is zero and b2 is -b0)
+  alignas(32) float formantB0[numLanes] = {};
+  alignas(32) float formantA1[numLanes] = {};
+  alignas(32) float formantA2[numLanes] = {};
+
+  struct FormantState {
+    alignas(32) float s1[numLanes] = {};
+    alignas(32) float s2[numLanes] = {};
   };
+  std::array<FormantState, maxChannels> formantState;
+
+  juce::LinearSmoothedValue<float> vowelPosition; // 0.0 - 4.0
+  juce::LinearSmoothedValue<float> formantQ{1.0f};
+  bool formantCoefficientsDirty = true;
 
-  // 5 parallel bands for formants
-  std::array<FormantBand, 5> formantBands;
   void updateFormantCoefficients();
+  void processFormants(float *samples, int numSamples, FormantState &state);
 
-  float vowelPosition = 0.0f; // 0.0 - 1.0
   juce::dsp::StateVariableTPTFilter<float> filter;
   FilterType currentType = LowPass;
   float sampleRate = 44100.0f;
@@ -0,0 +1,145 @@
+#include "GranularEngine.h"
+
+GranularEngine::GranularEngine() {}
+
+void GranularEngine::prepare(double newSampleRate, int samplesPerBlock) {
+  sampleRate = newSampleRate;
+  scratch.assign((size_t)juce::jmax(1, samplesPerBlock), 0.0f);
+  reset();
+}
+
+void GranularEngine::reset() {
+  for (auto &grain : pool)
+    grain.active = false;
+  samplesToNextGrain = 0;
+}
+
+void GranularEngine::setParams(const Params &newParams) {
+  params = newParams;
+  params.grainSizeMs = juce::jlimit(5.0f, 1000.0f, params.grainSizeMs);
+  params.density = juce::jlimit(0.5f, 200.0f, params.density);
+  params.position = juce::jlimit(0.0f, 1.0f, params.position);
+  params.spray = juce::jlimit(0.0f, 1.0f, params.spray);
+  params.maxGrains = juce::jlimit(1, maxGrainsLimit, params.maxGrains);
+
+  // Keep the summed level roughly constant as grains overlap
+  float overlap = params.density * params.grainSizeMs * 0.001f;
+  overlap = juce::jmin(overlap, (float)params.maxGrains);
+  grainGain = 1.0f / std::sqrt(juce::jmax(1.0f, overlap));
+}
+
+void GranularEngine::noteOn(const juce::AudioBuffer<float> *sourceData,
+                            int length, double sourceStep) {
+  reset();
+  source = sourceData;
+  sourceLength = length;
+  baseStep = sourceStep;
+}
+
+void GranularEngine::spawnGrain() {
+  int active = 0;
+  Grain *freeGrain = nullptr;
+  for (auto &grain : pool) {
+    if (grain.active)
+      ++active;
+    else if (freeGrain == nullptr)
+      freeGrain = &grain;
+  }
+
+  // Bounded cost: skip the grain rather than exceed the budget
+  if (freeGrain == nullptr || active >= params.maxGrains)
+    return;
+
+  const int length =
+      juce::jmax(16, (int)(params.grainSizeMs * 0.001 * sampleRate));
+  const double step =
+      baseStep * std::pow(2.0, (double)params.pitchSemitones / 12.0);
+
+  // Source span this grain will read, kept inside the data
+  const double span = step * length;
+  const double maxStart = (double)sourceLength - span - 2.0;
+  if (maxStart <= 0.0)
+    return;
+
+  double start = params.position * (double)sourceLength;
+  start += (random.nextFloat() * 2.0f - 1.0f) * params.spray * 0.25 *
+           (double)sourceLength;
+  start = juce::jlimit(0.0, maxStart, start);
+
+  const double omega = juce::MathConstants<double>::twoPi / (double)length;
+
+  freeGrain->active = true;
+  freeGrain->position = start;
+  freeGrain->step = step;
+  freeGrain->samplesLeft = length;
+  freeGrain->cosCurrent = 1.0f;
+  freeGrain->cosPrevious = (float)std::cos(omega);
+  freeGrain->cosCoeff = (float)(2.0 * std::cos(omega));
+}
+
+void GranularEngine::renderGrain(Grain &grain, float *dest, int numSamples) {
+  const int n = juce::jmin(numSamples, grain.samplesLeft);
+  const float *inL = source->getReadPointer(0);
+  const float *inR =
+      source->getNumChannels() > 1 ? source->getReadPointer(1) : nullptr;
+
+  float *out = scratch.data();
+  double pos = grain.position;
+  float c0 = grain.cosCurrent;
+  float c1 = grain.cosPrevious;
+  const float k = grain.cosCoeff;
+
+  // Gather pass: interpolated source * Hann window
+  for (int i = 0; i < n; ++i) {
+    const int idx = (int)pos;
+    const float alpha = (float)(pos - (double)idx);
+    float s = inL[idx] + alpha * (inL[idx + 1] - inL[idx]);
+    if (inR != nullptr)
+      s = 0.5f * (s + inR[idx] + alpha * (inR[idx + 1] - inR[idx]));
+
+    out[i] = s * (0.5f - 0.5f * c0);
+
+    const float next = k * c0 - c1;
+    c1 = c0;
+    c0 = next;
+    pos += grain.step;
+  }
+
+  // Mix pass (vectorised)
+  juce::FloatVectorOperations::addWithMultiply(dest, out, grainGain, n);
+
+  grain.position = pos;
+  grain.cosCurrent = c0;
+  grain.cosPrevious = c1;
+  grain.samplesLeft -= n;
+  if (grain.samplesLeft <= 0)
+    grain.active = false;
+}
+
+void GranularEngine::render(float *dest, int numSamples) {
+  if (source == nullptr || sourceLength <= 0 || scratch.empty())
+    return;
+
+  const int interval =
+      juce::jmax(1, (int)(sampleRate / (double)params.density));
+  const int maxChunk = (int)scratch.size();
+
+  int done = 0;
+  while (done < numSamples) {
+    // Render up to the next spawn point (or the end of the scratch space)
+    if (samplesToNextGrain <= 0) {
+      spawnGrain();
+      samplesToNextGrain = interval;
+    }
+
+    const int chunk =
+        juce::jmin(numSamples - done, samplesToNextGrain, maxChunk);
+
+    for (auto &grain : pool)
+      if (grain.active)
+        renderGrain(grain, dest + done, chunk);
+
+    samplesToNextGrain -= chunk;
+    done += chunk;
+  }
+}
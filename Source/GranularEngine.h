@@ -0,0 +1,72 @@
+#pragma once
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Per-voice granular player for textures and pads.
+
+    Grains come from a fixed, preallocated pool and are scheduled with a
+    sample-accurate countdown, so the audio thread never allocates or locks.
+    The number of simultaneous grains is capped by maxGrains, which bounds
+    the per-voice cost to maxGrains * numSamples reads.
+*/
+class GranularEngine {
+public:
+  static constexpr int maxGrainsLimit = 32;
+
+  struct Params {
+    float grainSizeMs = 80.0f;
+    float density = 20.0f;       // Grains per second
+    float position = 0.2f;       // 0..1 through the sample
+    float spray = 0.1f;          // 0..1 random position offset
+    float pitchSemitones = 0.0f; // Grain transposition
+    int maxGrains = 16;
+  };
+
+  GranularEngine();
+
+  void prepare(double sampleRate, int samplesPerBlock);
+  void reset();
+
+  void setParams(const Params &newParams);
+
+  // sourceStep = source samples per output sample at the played note
+  void noteOn(const juce::AudioBuffer<float> *sourceData, int sourceLength,
+              double sourceStep);
+
+  // Adds the grain cloud into dest
+  void render(float *dest, int numSamples);
+
+  // The render buffer sized in prepare(), for pinning in RAM
+  const std::vector<float> &getScratch() const { return scratch; }
+
+private:
+  struct Grain {
+    bool active = false;
+    double position = 0.0; // In source samples
+    double step = 1.0;
+    int samplesLeft = 0;
+    // Hann window as a recursive cosine: w = 0.5 - 0.5 * cos
+    float cosCurrent = 1.0f;
+    float cosPrevious = 1.0f;
+    float cosCoeff = 2.0f;
+  };
+
+  void spawnGrain();
+  void renderGrain(Grain &grain, float *dest, int numSamples);
+
+  std::array<Grain, maxGrainsLimit> pool;
+  std::vector<float> scratch;
+
+  Params params;
+  const juce::AudioBuffer<float> *source = nullptr;
+  int sourceLength = 0;
+  double baseStep = 1.0;
+  double sampleRate = 44100.0;
+  int samplesToNextGrain = 0;
+  float grainGain = 1.0f;
+
+  juce::Random random;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(GranularEngine)
+};
@@ -0,0 +1,175 @@
+#include "HalfBandResampler.h"
+
+namespace {
+// Elliptic-derived half-band with a 0.05 transition band either side of a
+// quarter of the input rate: 80 dB stop band, passband flat to 1e-7 dB.
+// Even entries belong to the first allpass path, odd ones to the second.
+constexpr float coefficients[] = {0.0602973910f, 0.2159714446f, 0.4125907204f,
+                                  0.6043586265f, 0.7727156537f, 0.9238861387f};
+
+// One low-rate step of both paths: a through the even coefficients, b
+// through the odd ones
+inline void allpassPair(float &a, float &b, float *x, float *y) {
+  for (int k = 0; k < (int)std::size(coefficients); k += 2) {
+    const float outA = (a - y[k]) * coefficients[k] + x[k];
+    x[k] = a;
+    y[k] = outA;
+    a = outA;
+
+    const float outB = (b - y[k + 1]) * coefficients[k + 1] + x[k + 1];
+    x[k + 1] = b;
+    y[k + 1] = outB;
+    b = outB;
+  }
+}
+} // namespace
+
+void HalfBandResampler::prepare(int maxBlockSize) {
+  halfRate.setSize(maxChannels, getMaxLowRateSamples(maxBlockSize));
+  reset();
+}
+
+void HalfBandResampler::setFactor(int newFactor) {
+  newFactor = newFactor >= 4 ? 4 : (newFactor >= 2 ? 2 : 1);
+  if (newFactor == factor)
+    return;
+
+  factor = newFactor;
+  reset();
+}
+
+void HalfBandResampler::reset() {
+  for (auto &stage : stages)
+    stage = Stage();
+  lowRateSamples.fill(0);
+}
+
+int HalfBandResampler::decimate(const float *const *input,
+                                float *const *output, int numChannels,
+                                int numSamples) {
+  numChannels = juce::jmin(numChannels, maxChannels);
+
+  if (factor == 1) {
+    for (int ch = 0; ch < numChannels; ++ch)
+      juce::FloatVectorOperations::copy(output[ch], input[ch], numSamples);
+    return numSamples;
+  }
+
+  if (factor == 2) {
+    lowRateSamples[0] =
+        decimateStage(stages[0], input, output, numChannels, numSamples);
+    return lowRateSamples[0];
+  }
+
+  float *half[maxChannels] = {halfRate.getWritePointer(0),
+                              halfRate.getWritePointer(1)};
+  lowRateSamples[0] =
+      decimateStage(stages[0], input, half, numChannels, numSamples);
+  lowRateSamples[1] =
+      decimateStage(stages[1], half, output, numChannels, lowRateSamples[0]);
+  return lowRateSamples[1];
+}
+
+void HalfBandResampler::addInterpolated(const float *const *input,
+                                        float *const *output,
+                                        int numChannels, int numSamples) {
+  numChannels = juce::jmin(numChannels, maxChannels);
+
+  if (factor == 1) {
+    for (int ch = 0; ch < numChannels; ++ch)
+      juce::FloatVectorOperations::add(output[ch], input[ch], numSamples);
+    return;
+  }
+
+  if (factor == 2) {
+    interpolateStage(stages[0], input, lowRateSamples[0], output,
+                     numChannels, numSamples, true);
+    return;
+  }
+
+  float *half[maxChannels] = {halfRate.getWritePointer(0),
+                              halfRate.getWritePointer(1)};
+  interpolateStage(stages[1], input, lowRateSamples[1], half, numChannels,
+                   lowRateSamples[0], false);
+  interpolateStage(stages[0], half, lowRateSamples[0], output, numChannels,
+                   numSamples, true);
+}
+
+int HalfBandResampler::decimateStage(Stage &stage, const float *const *input,
+                                     float *const *output, int numChannels,
+                                     int numSamples) {
+  int written = 0;
+  bool held = stage.inputHeld;
+
+  for (int ch = 0; ch < numChannels; ++ch) {
+    const float *in = input[ch];
+    float *out = output[ch];
+    float earlier = stage.heldInput[ch];
+    held = stage.inputHeld;
+    written = 0;
+
+    for (int i = 0; i < numSamples; ++i) {
+      if (!held) {
+        earlier = in[i];
+        held = true;
+        continue;
+      }
+
+      // The later sample of the pair takes the first path
+      float a = in[i];
+      float b = earlier;
+      allpassPair(a, b, stage.downX[ch], stage.downY[ch]);
+      out[written++] = 0.5f * (a + b);
+      held = false;
+    }
+    stage.heldInput[ch] = earlier;
+  }
+
+  stage.inputHeld = held;
+  return written;
+}
+
+void HalfBandResampler::interpolateStage(Stage &stage,
+                                         const float *const *input,
+                                         int numInputs, float *const *output,
+                                         int numChannels, int numOutputs,
+                                         bool adding) {
+  bool held = stage.outputHeld;
+
+  for (int ch = 0; ch < numChannels; ++ch) {
+    const float *in = input[ch];
+    float *out = output[ch];
+    int written = 0;
+    held = stage.outputHeld;
+
+    auto emit = [&](float sample) {
+      if (adding)
+        out[written++] += sample;
+      else
+        out[written++] = sample;
+    };
+
+    if (held && numOutputs > 0) {
+      emit(stage.heldOutput[ch]);
+      held = false;
+    }
+
+    for (int i = 0; i < numInputs; ++i) {
+      float a = in[i];
+      float b = in[i];
+      allpassPair(a, b, stage.upX[ch], stage.upY[ch]);
+
+      emit(a);
+      if (written < numOutputs) {
+        emit(b);
+      } else {
+        stage.heldOutput[ch] = b;
+        held = true;
+      }
+    }
+
+    jassert(written == numOutputs);
+  }
+
+  stage.outputHeld = held;
+}
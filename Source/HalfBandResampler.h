@@ -0,0 +1,76 @@
+#pragma once
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Takes a stereo signal down to 1/2 or 1/4 of the host rate and brings a
+    low-rate signal back up, using polyphase IIR half-band filters: each 2x
+    step is two chains of first-order allpasses running at the lower rate,
+    about six multiplies per low-rate sample and direction.
+
+    Each step rejects 80 dB from 0.3 of its input rate, so a round trip keeps
+    what lies below 0.2x the host rate at 1/2 rate and 0.1x at 1/4 (8.8 and
+    4.4 kHz at 44.1 kHz, twice that at 88.2). The phase isn't linear, which
+    suits a wet signal but not one that will be mixed against its own dry.
+
+    Blocks can be any length. The decimator carries an odd sample over, and
+    the interpolator starts one sample late, so addInterpolated() always
+    consumes exactly what decimate() produced for the same block.
+*/
+class HalfBandResampler {
+public:
+  static constexpr int maxChannels = 2;
+
+  HalfBandResampler() = default;
+
+  void prepare(int maxBlockSize); // Sizes the buffer between the 2x steps
+  void setFactor(int newFactor);  // 1, 2 or 4 (resets state)
+  int getFactor() const { return factor; }
+  void reset();
+
+  // Most low-rate samples decimate() writes for a block
+  static int getMaxLowRateSamples(int numSamples) {
+    return numSamples / 2 + 1;
+  }
+
+  // Decimates a host-rate block and returns how many low-rate samples it
+  // wrote to output
+  int decimate(const float *const *input, float *const *output,
+               int numChannels, int numSamples);
+
+  // Interpolates the low-rate samples for the block decimate() was last
+  // given and adds the numSamples host-rate result to output
+  void addInterpolated(const float *const *input, float *const *output,
+                       int numChannels, int numSamples);
+
+private:
+  static constexpr int numCoefficients = 6;
+
+  // One 2x step in each direction
+  struct Stage {
+    // Allpass input and output memories, per channel and coefficient
+    float downX[maxChannels][numCoefficients] = {};
+    float downY[maxChannels][numCoefficients] = {};
+    float upX[maxChannels][numCoefficients] = {};
+    float upY[maxChannels][numCoefficients] = {};
+
+    float heldInput[maxChannels] = {};  // Waiting for its pair
+    float heldOutput[maxChannels] = {}; // Second half of the last pair
+    bool inputHeld = false;
+    bool outputHeld = true; // The one-sample start offset
+  };
+
+  static int decimateStage(Stage &stage, const float *const *input,
+                           float *const *output, int numChannels,
+                           int numSamples);
+  static void interpolateStage(Stage &stage, const float *const *input,
+                               int numInputs, float *const *output,
+                               int numChannels, int numOutputs, bool adding);
+
+  int factor = 1;
+  std::array<Stage, 2> stages;        // Host <-> 1/2 rate, 1/2 <-> 1/4 rate
+  std::array<int, 2> lowRateSamples{}; // Per step, from the last decimate()
+  juce::AudioBuffer<float> halfRate;   // Between the steps at 1/4 rate
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(HalfBandResampler)
+};
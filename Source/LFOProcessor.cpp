@@ -28,6 +28,10 @@ float LFOProcessor::getNextSample() {
     else
       output = 3.0f - 4.0f * phase;
     break;
+
+  case Saw:
+    output = (float)(2.0 * phase - 1.0);
+    break;
   }
 
   // Advance phase
@@ -39,6 +43,86 @@ float LFOProcessor::getNextSample() {
   return output * currentDepth;
 }
 
+void LFOProcessor::renderBlock(float *dest, int numSamples,
+                               juce::AudioPlayHead *playHead,
+                               float fallbackBPM) {
+  if (numSamples <= 0)
+    return;
+
+  double increment = phaseIncrement;
+
+  if (syncBeats > 0.0) {
+    double bpm = fallbackBPM;
+    if (playHead) {
+      if (auto pos = playHead->getPosition()) {
+        if (pos->getBpm().hasValue() && *pos->getBpm() >= 20.0)
+          bpm = *pos->getBpm();
+
+        // Phase-lock to the host grid while it moves. A stopped transport
+        // reports the same PPQ every block, so locking then would restart
+        // the wobble each block; it runs free until playback starts.
+        auto ppq = pos->getPpqPosition();
+        if (pos->getIsPlaying() && ppq.hasValue()) {
+          double cycles = *ppq / syncBeats;
+          phase = cycles - std::floor(cycles);
+        }
+      }
+    }
+
+    increment = bpm / (60.0 * currentSampleRate * syncBeats);
+  }
+
+  // Read position includes the user phase offset; the stored phase does not
+  double p = phase + phaseOffset;
+  if (p >= 1.0)
+    p -= 1.0;
+
+  const float depth = currentDepth;
+
+  // Waveform switch hoisted out of the sample loop
+  switch (currentWaveform) {
+  case Sine:
+    for (int i = 0; i < numSamples; ++i) {
+      dest[i] = depth * (float)std::sin(p * juce::MathConstants<double>::twoPi);
+      p += increment;
+      if (p >= 1.0)
+        p -= 1.0;
+    }
+    break;
+
+  case Square:
+    for (int i = 0; i < numSamples; ++i) {
+      dest[i] = (p < 0.5) ? depth : -depth;
+      p += increment;
+      if (p >= 1.0)
+        p -= 1.0;
+    }
+    break;
+
+  case Triangle:
+    for (int i = 0; i < numSamples; ++i) {
+      float tri = (p < 0.5) ? (float)(-1.0 + 4.0 * p) : (float)(3.0 - 4.0 * p);
+      dest[i] = depth * tri;
+      p += increment;
+      if (p >= 1.0)
+        p -= 1.0;
+    }
+    break;
+
+  case Saw:
+    for (int i = 0; i < numSamples; ++i) {
+      dest[i] = depth * (float)(2.0 * p - 1.0);
+      p += increment;
+      if (p >= 1.0)
+        p -= 1.0;
+    }
+    break;
+  }
+
+  phase += increment * numSamples;
+  phase -= std::floor(phase);
+}
+
 void LFOProcessor::setWaveform(Waveform wave) { currentWaveform = wave; }
 
 void LFOProcessor::setRate(float rateHz) {
@@ -51,3 +135,13 @@ void LFOProcessor::setDepth(float depth) {
 }
 
 void LFOProcessor::setTarget(Target target) { currentTarget = target; }
+
+void LFOProcessor::setPhaseOffset(float phase01) {
+  phaseOffset = (double)juce::jlimit(0.0f, 1.0f, phase01);
+  if (phaseOffset >= 1.0)
+    phaseOffset = 0.0;
+}
+
+void LFOProcessor::setTempoSync(double beatsPerCycle) {
+  syncBeats = beatsPerCycle > 0.0 ? beatsPerCycle : 0.0;
+}
@@ -5,7 +5,7 @@ class LFOProcessor {
 public:
   LFOProcessor();
 
-  enum Waveform { Sine = 0, Square, Triangle };
+  enum Waveform { Sine = 0, Square, Triangle, Saw };
 
   enum Target { FilterCutoff = 0, Volume, Pan, Pitch };
 
@@ -13,10 +13,21 @@ public:
   void reset();
   float getNextSample();
 
+  // Renders a whole block of (depth-scaled) LFO values into dest.
+  // When tempo sync is on and the host is playing, the phase is locked to its
+  // PPQ position at the start of the block so every voice reading this buffer
+  // stays on the beat. With the transport stopped it runs free at the tempo.
+  void renderBlock(float *dest, int numSamples, juce::AudioPlayHead *playHead,
+                   float fallbackBPM = 120.0f);
+
   void setWaveform(Waveform wave);
   void setRate(float rateHz);
   void setDepth(float depth);
   void setTarget(Target target);
+  void setPhaseOffset(float phase01);
+
+  // Length of one LFO cycle in quarter notes (4.0 = 1 bar), 0 = free running
+  void setTempoSync(double beatsPerCycle);
 
   Target getTarget() const { return currentTarget; }
   float getDepth() const { return currentDepth; }
@@ -29,6 +40,8 @@ private:
 
   double phase = 0.0;
   double phaseIncrement = 0.0;
+  double phaseOffset = 0.0; // 0..1
+  double syncBeats = 0.0;
   double currentSampleRate = 44100.0;
 
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LFOProcessor)
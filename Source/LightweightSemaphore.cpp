@@ -0,0 +1,64 @@
+#include "LightweightSemaphore.h"
+
+#if JUCE_MAC || JUCE_IOS
+#include <dispatch/dispatch.h>
+#elif JUCE_WINDOWS
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <semaphore.h>
+#endif
+
+#if JUCE_MAC || JUCE_IOS
+struct LightweightSemaphore::Handle {
+  Handle() : semaphore(dispatch_semaphore_create(0)) {}
+  ~Handle() { dispatch_release(semaphore); }
+  dispatch_semaphore_t semaphore;
+};
+
+void LightweightSemaphore::wakeOne() {
+  dispatch_semaphore_signal(handle->semaphore);
+}
+
+void LightweightSemaphore::sleep() {
+  dispatch_semaphore_wait(handle->semaphore, DISPATCH_TIME_FOREVER);
+}
+#elif JUCE_WINDOWS
+struct LightweightSemaphore::Handle {
+  Handle() : semaphore(CreateSemaphoreW(nullptr, 0, MAXLONG, nullptr)) {}
+  ~Handle() { CloseHandle(semaphore); }
+  HANDLE semaphore;
+};
+
+void LightweightSemaphore::wakeOne() {
+  ReleaseSemaphore(handle->semaphore, 1, nullptr);
+}
+
+void LightweightSemaphore::sleep() {
+  WaitForSingleObject(handle->semaphore, INFINITE);
+}
+#else
+struct LightweightSemaphore::Handle {
+  Handle() { sem_init(&semaphore, 0, 0); }
+  ~Handle() { sem_destroy(&semaphore); }
+  sem_t semaphore;
+};
+
+void LightweightSemaphore::wakeOne() { sem_post(&handle->semaphore); }
+
+void LightweightSemaphore::sleep() {
+  while (sem_wait(&handle->semaphore) != 0 && errno == EINTR)
+    ;
+}
+#endif
+
+LightweightSemaphore::LightweightSemaphore()
+    : handle(std::make_unique<Handle>()) {}
+
+LightweightSemaphore::~LightweightSemaphore() = default;
@@ -0,0 +1,37 @@
+#pragma once
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    A counting semaphore that the audio thread can signal.
+
+    The count goes negative while a thread sleeps in wait(), so only then
+    does signal() go to the kernel, and the kernel semaphore (dispatch on
+    Apple, Win32 elsewhere on Windows, POSIX otherwise) posts without taking
+    a user-space lock. A signal with nobody waiting is a single atomic add.
+*/
+class LightweightSemaphore {
+public:
+  LightweightSemaphore();
+  ~LightweightSemaphore();
+
+  void signal() {
+    if (count.fetch_add(1, std::memory_order_release) < 0)
+      wakeOne();
+  }
+
+  void wait() {
+    if (count.fetch_sub(1, std::memory_order_acquire) <= 0)
+      sleep();
+  }
+
+private:
+  void wakeOne();
+  void sleep();
+
+  struct Handle;
+  std::unique_ptr<Handle> handle;
+  std::atomic<int> count{0};
+
+  JUCE_DECLARE_NON_COPYABLE(LightweightSemaphore)
+};
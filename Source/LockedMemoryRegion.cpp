@@ -0,0 +1,194 @@
+#include "LockedMemoryRegion.h"
+
+#include <map>
+#include <mutex>
+
+#if JUCE_WINDOWS
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace {
+std::atomic<size_t> lockBudget{256u * 1024u * 1024u};
+std::atomic<size_t> totalLocked{0};
+
+// How many regions hold each locked page, keyed by page address. Only
+// touched off the audio thread, under the lock.
+std::mutex pageMutex;
+std::map<std::uintptr_t, int> pageHolders;
+
+size_t getPageSize() {
+  return (size_t)juce::jmax(4096, juce::SystemStats::getPageSize());
+}
+
+bool lockPages(std::uintptr_t begin, std::uintptr_t end) {
+  auto *data = reinterpret_cast<void *>(begin);
+#if JUCE_WINDOWS
+  return VirtualLock(data, end - begin) != 0;
+#else
+  return mlock(data, end - begin) == 0;
+#endif
+}
+
+void unlockPages(std::uintptr_t begin, std::uintptr_t end) {
+  auto *data = reinterpret_cast<void *>(begin);
+#if JUCE_WINDOWS
+  VirtualUnlock(data, end - begin);
+#else
+  munlock(data, end - begin);
+#endif
+}
+
+// Calls fn(runBegin, runEnd) for each run of pages in [begin, end) that no
+// region holds
+template <typename Fn>
+void forEachUnheldRun(std::uintptr_t begin, std::uintptr_t end,
+                      size_t pageSize, Fn &&fn) {
+  for (auto page = begin; page < end;) {
+    if (pageHolders.count(page) != 0) {
+      page += pageSize;
+      continue;
+    }
+
+    auto runEnd = page + pageSize;
+    while (runEnd < end && pageHolders.count(runEnd) == 0)
+      runEnd += pageSize;
+    if (!fn(page, runEnd))
+      return;
+    page = runEnd;
+  }
+}
+
+void adviseHugePages(const void *data, size_t numBytes) {
+#if JUCE_LINUX && defined(MADV_HUGEPAGE)
+  // Only whole 2 MB pages inside the region can be promoted
+  constexpr std::uintptr_t hugePage = 2u * 1024u * 1024u;
+  const auto begin = reinterpret_cast<std::uintptr_t>(data);
+  const auto first = (begin + hugePage - 1) & ~(hugePage - 1);
+  const auto last = (begin + numBytes) & ~(hugePage - 1);
+
+  if (last > first)
+    madvise(reinterpret_cast<void *>(first), last - first, MADV_HUGEPAGE);
+#else
+  juce::ignoreUnused(data, numBytes);
+#endif
+}
+} // namespace
+
+LockedMemoryRegion::LockedMemoryRegion(const void *data, size_t numBytes) {
+  if (data == nullptr || numBytes == 0)
+    return;
+
+  adviseHugePages(data, numBytes);
+  prefault(data, numBytes);
+
+  const size_t pageSize = getPageSize();
+  const auto address = reinterpret_cast<std::uintptr_t>(data);
+  const auto begin = address & ~(std::uintptr_t)(pageSize - 1);
+  const auto end =
+      (address + numBytes + pageSize - 1) & ~(std::uintptr_t)(pageSize - 1);
+
+  const std::lock_guard<std::mutex> lock(pageMutex);
+
+  // Pages other regions hold are already locked and paid for
+  size_t newBytes = 0;
+  forEachUnheldRun(begin, end, pageSize, [&](auto runBegin, auto runEnd) {
+    newBytes += runEnd - runBegin;
+    return true;
+  });
+  if (totalLocked.load() + newBytes > lockBudget.load())
+    return; // Over budget: resident for now, but not pinned
+
+  std::uintptr_t failedAt = 0;
+  forEachUnheldRun(begin, end, pageSize, [&](auto runBegin, auto runEnd) {
+    if (lockPages(runBegin, runEnd))
+      return true;
+    failedAt = runBegin; // e.g. RLIMIT_MEMLOCK reached
+    return false;
+  });
+
+  if (failedAt != 0) {
+    forEachUnheldRun(begin, failedAt, pageSize, [](auto runBegin, auto runEnd) {
+      unlockPages(runBegin, runEnd);
+      return true;
+    });
+    return;
+  }
+
+  for (auto page = begin; page < end; page += pageSize)
+    ++pageHolders[page];
+  totalLocked += newBytes;
+
+  start = reinterpret_cast<const void *>(begin);
+  lockedBytes = end - begin;
+}
+
+LockedMemoryRegion::~LockedMemoryRegion() { release(); }
+
+LockedMemoryRegion::LockedMemoryRegion(LockedMemoryRegion &&other) noexcept
+    : start(other.start), lockedBytes(other.lockedBytes) {
+  other.start = nullptr;
+  other.lockedBytes = 0;
+}
+
+LockedMemoryRegion &
+LockedMemoryRegion::operator=(LockedMemoryRegion &&other) noexcept {
+  if (this != &other) {
+    release();
+    start = other.start;
+    lockedBytes = other.lockedBytes;
+    other.start = nullptr;
+    other.lockedBytes = 0;
+  }
+
+  return *this;
+}
+
+void LockedMemoryRegion::release() {
+  if (lockedBytes == 0)
+    return;
+
+  const size_t pageSize = getPageSize();
+  const auto begin = reinterpret_cast<std::uintptr_t>(start);
+  const auto end = begin + lockedBytes;
+
+  const std::lock_guard<std::mutex> lock(pageMutex);
+  for (auto page = begin; page < end; page += pageSize) {
+    auto holder = pageHolders.find(page);
+    jassert(holder != pageHolders.end());
+    if (holder != pageHolders.end() && --holder->second == 0)
+      pageHolders.erase(holder);
+  }
+
+  // The pages this was the last holder of
+  forEachUnheldRun(begin, end, pageSize, [](auto runBegin, auto runEnd) {
+    unlockPages(runBegin, runEnd);
+    totalLocked -= runEnd - runBegin;
+    return true;
+  });
+
+  start = nullptr;
+  lockedBytes = 0;
+}
+
+void LockedMemoryRegion::prefault(const void *data, size_t numBytes) {
+  if (data == nullptr || numBytes == 0)
+    return;
+
+  const auto *bytes = static_cast<const volatile char *>(data);
+  const size_t pageSize = getPageSize();
+  char sink = 0;
+
+  for (size_t offset = 0; offset < numBytes; offset += pageSize)
+    sink ^= bytes[offset];
+
+  sink ^= bytes[numBytes - 1];
+  juce::ignoreUnused(sink);
+}
+
+void LockedMemoryRegion::setBudget(size_t numBytes) { lockBudget = numBytes; }
+
+size_t LockedMemoryRegion::getBudget() { return lockBudget.load(); }
+
+size_t LockedMemoryRegion::getTotalLockedBytes() { return totalLocked.load(); }
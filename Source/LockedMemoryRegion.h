@@ -0,0 +1,48 @@
+#pragma once
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Keeps a block of memory resident for real-time use.
+
+    Construction touches every page (so the audio thread never takes the first
+    fault) and then pins the pages with mlock / VirtualLock, as long as the
+    process-wide budget allows. Large regions on Linux are also offered to
+    transparent hugepages.
+
+    Locks work on whole pages and don't nest, so regions are rounded out to
+    page boundaries and every locked page is counted process-wide: a page
+    shared by several regions (neighbouring channels, small objects) is
+    locked and charged to the budget once, and only unlocked when the last
+    region holding it is destroyed.
+
+    Create and destroy these off the audio thread.
+*/
+class LockedMemoryRegion {
+public:
+  LockedMemoryRegion() = default;
+  LockedMemoryRegion(const void *data, size_t numBytes);
+  ~LockedMemoryRegion();
+
+  LockedMemoryRegion(LockedMemoryRegion &&other) noexcept;
+  LockedMemoryRegion &operator=(LockedMemoryRegion &&other) noexcept;
+
+  bool isLocked() const { return lockedBytes > 0; }
+
+  // Reads one byte per page so the pages are resident, without locking
+  static void prefault(const void *data, size_t numBytes);
+
+  // Process-wide cap on locked memory (default 256 MB), in bytes of whole
+  // pages
+  static void setBudget(size_t numBytes);
+  static size_t getBudget();
+  static size_t getTotalLockedBytes();
+
+private:
+  void release();
+
+  const void *start = nullptr; // First page
+  size_t lockedBytes = 0;      // Whole pages from start
+
+  JUCE_DECLARE_NON_COPYABLE(LockedMemoryRegion)
+};
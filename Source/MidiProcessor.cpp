@@ -452,6 +452,55 @@ void ChordEngine::process(juce::MidiBuffer &midiMessages) {
   midiMessages.swapWith(processedBuf);
 }
 
+//==============================================================================
+// NoteCoalescer
+//==============================================================================
+
+void NoteCoalescer::prepare() {
+  coalescedBuf.ensureSize(2048);
+  reset();
+}
+
+void NoteCoalescer::reset() {
+  for (auto &channel : refCounts)
+    channel.fill(0);
+}
+
+void NoteCoalescer::process(juce::MidiBuffer &midiMessages) {
+  coalescedBuf.clear();
+
+  for (const auto metadata : midiMessages) {
+    auto msg = metadata.getMessage();
+    const int channel = juce::jlimit(1, 16, msg.getChannel()) - 1;
+
+    if (msg.isNoteOn()) {
+      auto &count = refCounts[(size_t)channel][(size_t)msg.getNoteNumber()];
+      ++count;
+
+      // Duplicates only pass when retriggering; the synth then restarts the
+      // voice already sounding instead of starting a second one
+      if (count == 1 || retrigger)
+        coalescedBuf.addEvent(msg, metadata.samplePosition);
+    } else if (msg.isNoteOff()) {
+      auto &count = refCounts[(size_t)channel][(size_t)msg.getNoteNumber()];
+
+      // Unknown notes (e.g. held across a reset) still get their note-off
+      if (count > 0)
+        --count;
+
+      if (count == 0)
+        coalescedBuf.addEvent(msg, metadata.samplePosition);
+    } else {
+      if (msg.isAllNotesOff() || msg.isAllSoundOff())
+        refCounts[(size_t)channel].fill(0);
+
+      coalescedBuf.addEvent(msg, metadata.samplePosition);
+    }
+  }
+
+  midiMessages.swapWith(coalescedBuf);
+}
+
 //==============================================================================
 // MidiProcessor
 //==============================================================================
@@ -461,9 +510,13 @@ MidiProcessor::MidiProcessor() {}
 void MidiProcessor::prepare(double sampleRate) {
   currentSampleRate = sampleRate;
   arp.prepare(sampleRate);
+  noteCoalescer.prepare();
 }
 
-void MidiProcessor::reset() { arp.reset(); }
+void MidiProcessor::reset() {
+  arp.reset();
+  noteCoalescer.reset();
+}
 
 void MidiProcessor::process(juce::MidiBuffer &midiMessages, int numSamples,
                             juce::AudioPlayHead *playHead, float fallbackBPM) {
@@ -472,4 +525,7 @@ void MidiProcessor::process(juce::MidiBuffer &midiMessages, int numSamples,
 
   // 2. Arp Second
   arp.process(midiMessages, numSamples, playHead, fallbackBPM);
+
+  // 3. One voice per key, however many sources asked for it
+  noteCoalescer.process(midiMessages);
 }
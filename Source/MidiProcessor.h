@@ -95,6 +95,28 @@ private:
   // And NoteOff(C) -> NoteOff(C, E, G).
 };
 
+//==============================================================================
+// Note Coalescer Module
+//==============================================================================
+// Reference-counts notes per channel/key so overlapping chord and arp notes
+// only ever hold one voice: repeated note-ons are dropped (or retrigger the
+// sounding note) and only the last note-off for a key is passed on.
+class NoteCoalescer {
+public:
+  NoteCoalescer() = default;
+
+  void prepare();
+  void process(juce::MidiBuffer &midiMessages);
+  void reset();
+
+  void setRetrigger(bool shouldRetrigger) { retrigger = shouldRetrigger; }
+
+private:
+  std::array<std::array<int, 128>, 16> refCounts{};
+  juce::MidiBuffer coalescedBuf; // Reused every block
+  bool retrigger = false;
+};
+
 //==============================================================================
 // MidiProcessor (Main Handler)
 //==============================================================================
@@ -111,12 +133,14 @@ public:
   // Accessors for Modules
   Arpeggiator &getArp() { return arp; }
   ChordEngine &getChordEngine() { return chordEngine; }
+  NoteCoalescer &getNoteCoalescer() { return noteCoalescer; }
 
   int getCurrentArpStep() const { return arp.getCurrentStep(); }
 
 private:
   Arpeggiator arp;
   ChordEngine chordEngine;
+  NoteCoalescer noteCoalescer;
 
   double currentSampleRate = 44100.0;
 };
@@ -3,7 +3,7 @@
 ModulateTab::ModulateTab(HowlingWolvesAudioProcessor &p) : audioProcessor(p) {
   // --- 1. LFO VISUALIZER (TOP) ---
   setupLabel(visTitle, "LFO 1 VISUALIZER");
-  setupLabel(syncLabel, "SYNC: 1/4");
+  setupLabel(syncLabel, "SYNC: FREE");
 
   // --- 2. LFO PARAMETERS (LEFT PANEL) ---
   setupLabel(lfoTitle, "LFO PARAMETERS");
@@ -11,7 +11,7 @@ ModulateTab::ModulateTab(HowlingWolvesAudioProcessor &p) : audioProcessor(p) {
   addAndMakeVisible(waveSelector);
   setupLabel(waveLabel, "WAVE SHAPE");
   waveSelector.addItemList(
-      {"SINE", "SQUARE", "TRIANGLE"},
+      {"SINE", "SQUARE", "TRIANGLE", "SAW"},
       1); // Matching Processor choices order usually: Sine, Square, Triangle
   // User Snippet: {"SINE", "TRIANGLE", "SAW", "SQUARE"}.
   // Processor: Sine, Square, Triangle.
@@ -110,6 +110,12 @@ void ModulateTab::timerCallback() {
   if (isAnyVoiceActive) {
     phaseOffset += 0.05f;
   }
+
+  if (auto *p = audioProcessor.getAPVTS().getParameter("lfoSync")) {
+    auto syncText = "SYNC: " + p->getCurrentValueAsText().toUpperCase();
+    if (syncLabel.getText() != syncText)
+      syncLabel.setText(syncText, juce::dontSendNotification);
+  }
   repaint();
 }
 
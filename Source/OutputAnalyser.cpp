@@ -0,0 +1,167 @@
+#include "OutputAnalyser.h"
+
+namespace {
+constexpr double lowestBandHz = 30.0;
+constexpr float spectrumFloorDb = -72.0f;
+constexpr float spectrumAttack = 0.5f;  // Per update, towards a louder value
+constexpr float spectrumRelease = 0.1f; // Per update, towards a quieter one
+constexpr float meterDecay = 0.85f;     // Per update with no new audio
+constexpr float bandScale = 5.0f;       // RMS to bar height
+} // namespace
+
+OutputAnalyser::OutputAnalyser()
+    : fifoBuffer((size_t)fifoSize, 0.0f), incoming((size_t)fifoSize, 0.0f),
+      history((size_t)fftSize, 0.0f), fftData((size_t)(2 * fftSize), 0.0f) {}
+
+void OutputAnalyser::push(const juce::AudioBuffer<float> &buffer) {
+  const int numSamples = buffer.getNumSamples();
+  const int numChannels = buffer.getNumChannels();
+  if (numSamples <= 0 || numChannels <= 0)
+    return;
+
+  const int numOut = (numSamples + (hasPending ? 1 : 0)) / decimation;
+  if (fifo.getFreeSpace() < numOut) {
+    hasPending = false;
+    return;
+  }
+
+  int start1, size1, start2, size2;
+  fifo.prepareToWrite(numOut, start1, size1, start2, size2);
+
+  const float *left = buffer.getReadPointer(0);
+  const float *right = buffer.getReadPointer(numChannels > 1 ? 1 : 0);
+  float *dest = fifoBuffer.data() + start1;
+  int left1 = size1;
+
+  // Mono sum, then the mean of each pair: a cheap anti-alias for the 2:1
+  for (int i = 0; i < numSamples; ++i) {
+    const float mono = 0.5f * (left[i] + right[i]);
+    if (!hasPending) {
+      pendingSample = mono;
+      hasPending = true;
+      continue;
+    }
+
+    if (left1 == 0) {
+      dest = fifoBuffer.data() + start2;
+      left1 = size2;
+    }
+    *dest++ = 0.5f * (pendingSample + mono);
+    --left1;
+    hasPending = false;
+  }
+
+  fifo.finishedWrite(size1 + size2);
+}
+
+//==============================================================================
+void OutputAnalyser::update() {
+  const double analysisRate = sourceRate.load() / decimation;
+  if (analysisRate != preparedRate)
+    prepareAnalysis(analysisRate);
+
+  const int ready = fifo.getNumReady();
+  if (ready == 0) {
+    decay();
+    return;
+  }
+
+  int start1, size1, start2, size2;
+  fifo.prepareToRead(ready, start1, size1, start2, size2);
+  std::copy(fifoBuffer.begin() + start1, fifoBuffer.begin() + start1 + size1,
+            incoming.begin());
+  std::copy(fifoBuffer.begin() + start2, fifoBuffer.begin() + start2 + size2,
+            incoming.begin() + size1);
+  fifo.finishedRead(size1 + size2);
+
+  const int numNew = size1 + size2;
+  updateBands(incoming.data(), numNew);
+
+  // Slide the newest samples into the FFT history
+  const int keep = juce::jmax(0, fftSize - numNew);
+  const int take = fftSize - keep;
+  std::copy(history.begin() + (fftSize - keep), history.end(),
+            history.begin());
+  std::copy(incoming.begin() + (numNew - take), incoming.begin() + numNew,
+            history.begin() + keep);
+  updateSpectrum();
+}
+
+void OutputAnalyser::prepareAnalysis(double analysisRate) {
+  preparedRate = analysisRate;
+
+  juce::dsp::ProcessSpec spec{analysisRate, (juce::uint32)fifoSize, 1};
+  filterLow.prepare(spec);
+  filterLow.setType(juce::dsp::StateVariableTPTFilterType::lowpass);
+  filterLow.setCutoffFrequency(300.0f); // Low band < 300Hz
+  filterMid.prepare(spec);
+  filterMid.setType(juce::dsp::StateVariableTPTFilterType::bandpass);
+  filterMid.setCutoffFrequency(1000.0f); // Mid band center 1kHz
+  filterHigh.prepare(spec);
+  filterHigh.setType(juce::dsp::StateVariableTPTFilterType::highpass);
+  filterHigh.setCutoffFrequency(5000.0f); // High band > 5kHz
+
+  // Log-spaced band edges from lowestBandHz up to Nyquist, at least one bin
+  // apart so the bottom bands don't collapse onto the same bin
+  const double binHz = analysisRate / fftSize;
+  const double ratio = (analysisRate * 0.5) / lowestBandHz;
+  int previous = 0;
+  for (int b = 0; b <= numSpectrumBands; ++b) {
+    const double hz =
+        lowestBandHz * std::pow(ratio, (double)b / numSpectrumBands);
+    const int bin = juce::jlimit(1, fftSize / 2, juce::roundToInt(hz / binHz));
+    bandEdges[(size_t)b] =
+        juce::jmin(fftSize / 2, juce::jmax(bin, previous + 1));
+    previous = bandEdges[(size_t)b];
+  }
+
+  std::fill(history.begin(), history.end(), 0.0f);
+  spectrum.fill(0.0f);
+}
+
+void OutputAnalyser::updateBands(const float *samples, int numSamples) {
+  float sumLow = 0.0f, sumMid = 0.0f, sumHigh = 0.0f;
+  for (int i = 0; i < numSamples; ++i) {
+    const float low = filterLow.processSample(0, samples[i]);
+    const float mid = filterMid.processSample(0, samples[i]);
+    const float high = filterHigh.processSample(0, samples[i]);
+    sumLow += low * low;
+    sumMid += mid * mid;
+    sumHigh += high * high;
+  }
+
+  const float norm = 1.0f / (float)numSamples;
+  levelLow = std::sqrt(sumLow * norm) * bandScale;
+  levelMid = std::sqrt(sumMid * norm) * bandScale;
+  levelHigh = std::sqrt(sumHigh * norm) * bandScale;
+}
+
+void OutputAnalyser::updateSpectrum() {
+  std::copy(history.begin(), history.end(), fftData.begin());
+  std::fill(fftData.begin() + fftSize, fftData.end(), 0.0f);
+  window.multiplyWithWindowingTable(fftData.data(), (size_t)fftSize);
+  fft.performFrequencyOnlyForwardTransform(fftData.data(), true);
+
+  // A full-scale sine peaks at fftSize / 4 through the Hann window
+  const float toFullScale = 4.0f / (float)fftSize;
+  for (int b = 0; b < numSpectrumBands; ++b) {
+    float peak = 0.0f;
+    for (int bin = bandEdges[(size_t)b]; bin < bandEdges[(size_t)b + 1]; ++bin)
+      peak = juce::jmax(peak, fftData[(size_t)bin]);
+
+    const float db = juce::Decibels::gainToDecibels(peak * toFullScale,
+                                                    spectrumFloorDb);
+    const float target = juce::jmap(db, spectrumFloorDb, 0.0f, 0.0f, 1.0f);
+    auto &value = spectrum[(size_t)b];
+    value += (target > value ? spectrumAttack : spectrumRelease) *
+             (target - value);
+  }
+}
+
+void OutputAnalyser::decay() {
+  levelLow *= meterDecay;
+  levelMid *= meterDecay;
+  levelHigh *= meterDecay;
+  for (auto &value : spectrum)
+    value = value * meterDecay < silenceLevel ? 0.0f : value * meterDecay;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Output metering split across threads.
+
+    The audio thread only pushes a mono, 2:1 decimated copy of the output into
+    a lock-free single-producer/single-consumer FIFO. The UI timer drains it,
+    runs the low/mid/high band filters and a windowed FFT, and folds the FFT
+    into log-spaced, time-smoothed bands for display.
+*/
+class OutputAnalyser {
+public:
+  static constexpr int numSpectrumBands = 48;
+  static constexpr int decimation = 2;
+
+  OutputAnalyser();
+
+  // --- Audio thread ---
+  void prepare(double newSampleRate) { sourceRate = newSampleRate; }
+
+  // Mixes down, decimates and queues the block. If the consumer has fallen
+  // behind (or there is no editor) the block is dropped.
+  void push(const juce::AudioBuffer<float> &buffer);
+
+  // --- Consumer (UI timer) only ---
+  // Drains the FIFO and refreshes the levels and spectrum
+  void update();
+
+  // Band RMS levels, scaled so a healthy signal sits around 0..1
+  float getLow() const { return levelLow; }
+  float getMid() const { return levelMid; }
+  float getHigh() const { return levelHigh; }
+
+  // 0..1 per log-spaced band (-72..0 dBFS), lowest frequency first
+  const std::array<float, numSpectrumBands> &getSpectrum() const {
+    return spectrum;
+  }
+
+private:
+  static constexpr int fifoSize = 16384;
+  static constexpr int fftOrder = 11;
+  static constexpr int fftSize = 1 << fftOrder;
+  static constexpr float silenceLevel = 1.0e-6f;
+
+  void prepareAnalysis(double analysisRate);
+  void updateBands(const float *samples, int numSamples);
+  void updateSpectrum();
+  void decay();
+
+  // Shared
+  juce::AbstractFifo fifo{fifoSize};
+  std::vector<float> fifoBuffer;
+  std::atomic<double> sourceRate{44100.0};
+
+  // Audio thread
+  float pendingSample = 0.0f; // Odd sample left over from the last block
+  bool hasPending = false;
+
+  // Consumer
+  double preparedRate = 0.0;
+  std::vector<float> incoming;
+  std::vector<float> history; // Latest fftSize samples
+  std::vector<float> fftData;
+  juce::dsp::FFT fft{fftOrder};
+  juce::dsp::WindowingFunction<float> window{
+      (size_t)fftSize, juce::dsp::WindowingFunction<float>::hann};
+  std::array<int, numSpectrumBands + 1> bandEdges{}; // FFT bin boundaries
+
+  juce::dsp::StateVariableTPTFilter<float> filterLow, filterMid, filterHigh;
+  float levelLow = 0.0f, levelMid = 0.0f, levelHigh = 0.0f;
+  std::array<float, numSpectrumBands> spectrum{};
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OutputAnalyser)
+};
@@ -0,0 +1,67 @@
+#pragma once
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    A smoothed parameter's values for one stretch of samples, so a kernel can
+    be written once for a parameter that holds still and once for one that
+    moves, instead of asking the smoother for every sample.
+
+    generate() moves the smoother on. A smoother at rest reports static and
+    the kernel uses getValue() throughout; a moving one fills the ramp with a
+    vectorised multiply-add, clamped where it reaches its target.
+
+    The storage is a fixed array, so nothing allocates and any sample rate or
+    block size works: kernels walk their block in runs of at most maxLength.
+*/
+class ParameterRamp {
+public:
+  static constexpr int maxLength = 256;
+
+  // Takes the smoother through numSamples (at most maxLength). Returns true
+  // if it was moving, with one value per sample in getRamp(); otherwise it
+  // holds at getValue() for the whole run.
+  bool generate(juce::LinearSmoothedValue<float> &smoother, int numSamples) {
+    jassert(numSamples <= maxLength);
+    ramping = smoother.isSmoothing() && numSamples > 0;
+    if (!ramping) {
+      value = smoother.getCurrentValue();
+      return false;
+    }
+
+    const float start = smoother.getCurrentValue();
+    const float target = smoother.getTargetValue();
+    const float step = smoother.getNextValue() - start;
+    value = smoother.skip(numSamples - 1);
+
+    float *ramp = values.data();
+    for (int i = 0; i < numSamples; ++i)
+      ramp[i] = start + step * (float)(i + 1);
+
+    // The smoother stops on the target partway through a run
+    if (step > 0.0f)
+      juce::FloatVectorOperations::min(ramp, ramp, target, numSamples);
+    else
+      juce::FloatVectorOperations::max(ramp, ramp, target, numSamples);
+    return true;
+  }
+
+  bool isRamping() const { return ramping; }
+
+  // The held value, or where the ramp ended
+  float getValue() const { return value; }
+
+  // Per-sample values from the last generate(). A static run is filled with
+  // its value first, for kernels that take several parameters and ramp them
+  // all as soon as one moves.
+  float *getRamp(int numSamples) {
+    if (!ramping)
+      juce::FloatVectorOperations::fill(values.data(), value, numSamples);
+    return values.data();
+  }
+
+private:
+  std::array<float, maxLength> values{};
+  float value = 0.0f;
+  bool ramping = false;
+};
@@ -17,9 +17,17 @@ HowlingWolvesAudioProcessor::HowlingWolvesAudioProcessor()
 
   // Load saved license from disk on plugin startup
   isLicenseValid.store(licenseManager.loadSavedLicense());
+
+  for (auto *id : effectGraphParameters)
+    apvts.addParameterListener(id, this);
+  rebuildEffectGraph();
 }
 
 HowlingWolvesAudioProcessor::~HowlingWolvesAudioProcessor() {
+  for (auto *id : effectGraphParameters)
+    apvts.removeParameterListener(id, this);
+  cancelPendingUpdate();
+
   // Stop audio callback interaction immediately
   suspendProcessing(true);
 
@@ -28,6 +36,44 @@ HowlingWolvesAudioProcessor::~HowlingWolvesAudioProcessor() {
   synthEngine.clearVoices();
 }
 
+//==============================================================================
+void HowlingWolvesAudioProcessor::parameterChanged(const juce::String &,
+                                                   float) {
+  // May come from the audio thread (automation); rebuild on the message one
+  triggerAsyncUpdate();
+}
+
+void HowlingWolvesAudioProcessor::handleAsyncUpdate() { rebuildEffectGraph(); }
+
+void HowlingWolvesAudioProcessor::rebuildEffectGraph() {
+  auto isOn = [this](const char *id) {
+    auto *p = apvts.getRawParameterValue(id);
+    return p != nullptr && p->load() > 0.5f;
+  };
+
+  int preset = 0;
+  if (auto *p = apvts.getRawParameterValue("CHAIN_ORDER"))
+    preset = juce::jlimit(0, 4, (int)p->load());
+
+  using Node = EffectGraph::Node;
+  auto graph = EffectGraph::fromPreset((EffectGraph::Preset)preset);
+  graph.setBypassed(Node::Distortion, isOn("distBypass"));
+  graph.setBypassed(Node::Bitcrusher, !isOn("bitcrushOn"));
+  graph.setBypassed(Node::TransientShaper, isOn("biteBypass"));
+  graph.setBypassed(Node::Delay, isOn("delayBypass"));
+  graph.setBypassed(Node::Reverb, isOn("reverbBypass"));
+
+  // The helper thread starts and stops with the graph, so it is set here
+  // rather than from the audio thread
+  effectsProcessor.setHelperThreadEnabled(isOn("fxHelperThread"));
+
+  // Every swap dips the output briefly, so only send real changes
+  if (graph != publishedGraph) {
+    publishedGraph = graph;
+    effectsProcessor.setGraph(graph);
+  }
+}
+
 //==============================================================================
 const juce::String HowlingWolvesAudioProcessor::getName() const {
   return JucePlugin_Name;
@@ -57,7 +103,14 @@ bool HowlingWolvesAudioProcessor::isMidiEffect() const {
 #endif
 }
 
-double HowlingWolvesAudioProcessor::getTailLengthSeconds() const { return 0.0; }
+double HowlingWolvesAudioProcessor::getTailLengthSeconds() const {
+  // Voices ring out for their release, then the delay/reverb tails
+  double release = 0.0;
+  if (auto *p = apvts.getRawParameterValue("release"))
+    release = p->load();
+
+  return release + effectsProcessor.getTailLengthSeconds();
+}
 
 int HowlingWolvesAudioProcessor::getNumPrograms() {
   return 1; // NB: some hosts don't cope very well if you tell them there are 0
@@ -79,17 +132,54 @@ void HowlingWolvesAudioProcessor::changeProgramName(
 //==============================================================================
 void HowlingWolvesAudioProcessor::prepareToPlay(double sampleRate,
                                                 int samplesPerBlock) {
+  // Voices use at most eight mono blocks and rewind after each voice; the
+  // effects run after them and need five for the delay, plus a copy of the
+  // input and one per branch on every channel while a parallel stage runs
+  // the delay in one of its branches. Each allocation may be padded by up to
+  // one cache line.
+  const auto numChannels = (size_t)juce::jmax(1, getTotalNumOutputChannels());
+  const auto paddedBlock = (size_t)samplesPerBlock + 16;
+  const size_t parallelBlocks = (1 + EffectGraph::maxBranches) * numChannels;
+  bool lockMemory = false;
+  if (auto *p = apvts.getRawParameterValue("lockSampleMemory"))
+    lockMemory = p->load() > 0.5f;
+  scratchArena.prepare(paddedBlock * juce::jmax((size_t)8, 5 + parallelBlocks),
+                       lockMemory);
+
+  preparedBlockSize = juce::jmax(1, samplesPerBlock);
+  subBlockPlayHead.sampleRate = sampleRate;
+  subBlockMidi.ensureSize(4096);
+  hostBlockMidi.ensureSize(4096);
+
   synthEngine.setCurrentPlaybackSampleRate(sampleRate);
-  synthEngine.prepare(sampleRate, samplesPerBlock);
+  synthEngine.prepare(sampleRate, samplesPerBlock, scratchArena, lockMemory);
   midiProcessor.prepare(sampleRate);
   midiCapturer.prepare(sampleRate);
 
+  lfoProcessor.prepare(sampleRate);
+  globalLfoBuffer.setSize(1, samplesPerBlock, false, false, true);
+
   juce::dsp::ProcessSpec spec;
   spec.sampleRate = sampleRate;
   spec.maximumBlockSize = samplesPerBlock;
   spec.numChannels = getTotalNumOutputChannels();
 
-  effectsProcessor.prepare(spec);
+  // The wet rate, shaper lookahead and oversampling are applied straight
+  // away rather than faded in
+  if (auto *p = apvts.getRawParameterValue("fxWetRate"))
+    effectsProcessor.setWetPathRate((int)p->load());
+  if (auto *p = apvts.getRawParameterValue("fxOversampling"))
+    effectsProcessor.setOversampling((int)p->load());
+  {
+    auto *linkParam = apvts.getRawParameterValue("biteLink");
+    auto *lookaheadParam = apvts.getRawParameterValue("biteLookahead");
+    effectsProcessor.setTransientShaperMode(
+        linkParam == nullptr || linkParam->load() > 0.5f,
+        lookaheadParam != nullptr && lookaheadParam->load() > 0.5f);
+  }
+  effectsProcessor.prepare(spec, scratchArena);
+  filterProcessor.prepare(spec);
+  setLatencySamples(effectsProcessor.getLatencySamples());
 }
 
 void HowlingWolvesAudioProcessor::releaseResources() {
@@ -109,6 +199,58 @@ bool HowlingWolvesAudioProcessor::isBusesLayoutSupported(
 void HowlingWolvesAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
                                                juce::MidiBuffer &midiMessages) {
   juce::ScopedNoDenormals noDenormals;
+  subBlockPlayHead.host = getPlayHead();
+  subBlockPlayHead.offset = 0;
+
+  const int numSamples = buffer.getNumSamples();
+  if (numSamples <= preparedBlockSize) {
+    processSubBlock(buffer, midiMessages);
+    return;
+  }
+
+  // Hosts may send more than they announced (offline bounces, some
+  // standalone drivers): take it in prepared-size slices, each with the
+  // events that fall inside it, and gather the processed events back
+  hostBlockMidi.clear();
+  for (int start = 0; start < numSamples; start += preparedBlockSize) {
+    const int length = juce::jmin(preparedBlockSize, numSamples - start);
+    juce::AudioBuffer<float> slice(buffer.getArrayOfWritePointers(),
+                                   buffer.getNumChannels(), start, length);
+    subBlockMidi.clear();
+    subBlockMidi.addEvents(midiMessages, start, length, -start);
+    subBlockPlayHead.offset = start;
+
+    processSubBlock(slice, subBlockMidi);
+    hostBlockMidi.addEvents(subBlockMidi, 0, length, start);
+  }
+  midiMessages.swapWith(hostBlockMidi);
+}
+
+juce::Optional<juce::AudioPlayHead::PositionInfo>
+HowlingWolvesAudioProcessor::SubBlockPlayHead::getPosition() const {
+  if (host == nullptr)
+    return {};
+
+  auto pos = host->getPosition();
+  if (!pos.hasValue() || offset == 0 || !pos->getIsPlaying())
+    return pos;
+
+  // A stopped transport stays put; a playing one has moved on by the offset
+  const double seconds = offset / sampleRate;
+  if (auto samples = pos->getTimeInSamples())
+    pos->setTimeInSamples(*samples + offset);
+  if (auto time = pos->getTimeInSeconds())
+    pos->setTimeInSeconds(*time + seconds);
+  if (auto ppq = pos->getPpqPosition())
+    if (auto bpm = pos->getBpm())
+      pos->setPpqPosition(*ppq + seconds * *bpm / 60.0);
+  return pos;
+}
+
+void HowlingWolvesAudioProcessor::processSubBlock(
+    juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages) {
+  // Everything taken from the arena this slice is released on return
+  const ScratchArena::Scope blockScratch(scratchArena);
   auto totalNumInputChannels = getTotalNumInputChannels();
   auto totalNumOutputChannels = getTotalNumOutputChannels();
 
@@ -121,7 +263,8 @@ void HowlingWolvesAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
   }
 
   // --- 0. Transport Logic (Host vs Internal) ---
-  juce::AudioPlayHead *playHead = getPlayHead();
+  juce::AudioPlayHead *playHead =
+      subBlockPlayHead.host != nullptr ? &subBlockPlayHead : nullptr;
   bool isPlaying = false;
   double bpm = 120.0;
 
@@ -182,7 +325,7 @@ void HowlingWolvesAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
   // 2. Perform Midi Transformation (Arp / Chords)
   // 2. Perform Midi Transformation (Arp / Chords)
   float currentBPM = 120.0f;
-  if (auto *ph = getPlayHead()) {
+  if (auto *ph = playHead) {
     if (auto pos = ph->getPosition()) {
       if (pos->getBpm().hasValue()) {
         currentBPM = (float)*pos->getBpm();
@@ -199,7 +342,7 @@ void HowlingWolvesAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
   if (currentBPM <= 0.0f || currentBPM == 120.0f) { // If default or invalid
     // Wait, 120 is default. But if DAW says 120, we shouldn't override?
     // Check playHead again. If ph is null, we are in Standalone.
-    if (!getPlayHead() || !getPlayHead()->getPosition()) {
+    if (!playHead || !playHead->getPosition()) {
       currentBPM = manualBPM;
       internalBPM.store(currentBPM);
     }
@@ -215,7 +358,7 @@ void HowlingWolvesAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
 
   // Pass currentBPM as fallback to MidiProcessor (it will use PlayHead if
   // available, but this arg is for safety)
-  midiProcessor.process(midiMessages, buffer.getNumSamples(), getPlayHead(),
+  midiProcessor.process(midiMessages, buffer.getNumSamples(), playHead,
                         currentBPM);
 
   // Read parameters from APVTS and apply to synth engine (Josh Hodge pattern)
@@ -258,6 +401,15 @@ void HowlingWolvesAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
 
     int fType = (int)filterTypeParam->load();
 
+    // Formant runs on the summed synth output; the voices skip their filter
+    formantFilterOn = fType == FilterProcessor::Formant;
+    if (formantFilterOn) {
+      filterProcessor.setFilterType(FilterProcessor::Formant);
+      filterProcessor.setResonance(filterResParam->load());
+      if (auto *p = apvts.getRawParameterValue("filterVowel"))
+        filterProcessor.setVowel(p->load());
+    }
+
     synthEngine.updateParams(
         attackParam->load(), decayParam->load(), sustainParam->load(),
         releaseParam->load(), filterCutoffParam->load(), filterResParam->load(),
@@ -278,6 +430,12 @@ void HowlingWolvesAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
       synthEngine.updateModParams(modA->load(), modD->load(), modS->load(),
                                   modR->load(), modAmt->load(), tgt);
     }
+
+    // Envelope curve shapes (0 = linear)
+    auto *ampCurve = apvts.getRawParameterValue("ampCurve");
+    auto *modCurve = apvts.getRawParameterValue("modCurve");
+    if (ampCurve && modCurve)
+      synthEngine.setEnvelopeCurves(ampCurve->load(), modCurve->load());
   }
 
   // --- Update Midi Processor ---
@@ -318,6 +476,9 @@ void HowlingWolvesAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
     midiProcessor.getChordEngine().setParameters(chordModeIdx, 0, chordHold);
   }
 
+  if (auto *retrigParam = apvts.getRawParameterValue("noteRetrigger"))
+    midiProcessor.getNoteCoalescer().setRetrigger(retrigParam->load() > 0.5f);
+
   // --- MIDI Capture (After processing, before Synth) ---
   midiCapturer.processMidi(midiMessages, buffer.getNumSamples());
 
@@ -363,6 +524,12 @@ void HowlingWolvesAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
 
   synthEngine.updateSampleParams(tuneVal, startVal, effectiveEnd, loopVal);
 
+  // Portamento and pitch-bend range
+  auto *glideParam = apvts.getRawParameterValue("glideTime");
+  auto *bendParam = apvts.getRawParameterValue("bendRange");
+  if (glideParam && bendParam)
+    synthEngine.setPitchParams(glideParam->load(), bendParam->load());
+
   // Voice-level controls
   float ampPanVal = ampPanParam ? ampPanParam->load() : 0.0f;
   float ampVelVal = ampVelocityParam ? ampVelocityParam->load() : 1.0f;
@@ -372,6 +539,48 @@ void HowlingWolvesAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
   synthEngine.updateVoiceControls(ampPanVal, ampVelVal, driveVal, lfoPhaseVal,
                                   modSmoothVal);
 
+  // Granular playback
+  {
+    GranularEngine::Params grainParams;
+    if (auto *p = apvts.getRawParameterValue("grainSize"))
+      grainParams.grainSizeMs = p->load();
+    if (auto *p = apvts.getRawParameterValue("grainDensity"))
+      grainParams.density = p->load();
+    if (auto *p = apvts.getRawParameterValue("grainPosition"))
+      grainParams.position = p->load();
+    if (auto *p = apvts.getRawParameterValue("grainSpray"))
+      grainParams.spray = p->load();
+    if (auto *p = apvts.getRawParameterValue("grainPitch"))
+      grainParams.pitchSemitones = p->load();
+    if (auto *p = apvts.getRawParameterValue("grainMaxGrains"))
+      grainParams.maxGrains = (int)p->load();
+
+    bool grainModeOn = false;
+    if (auto *p = apvts.getRawParameterValue("grainMode"))
+      grainModeOn = p->load() > 0.5f;
+
+    synthEngine.setGranularParams(grainParams, grainModeOn);
+  }
+
+  // Decimated rendering for low bass voices
+  if (auto *p = apvts.getRawParameterValue("bassMultiRate"))
+    synthEngine.setMultiRate(p->load() > 0.5f);
+
+  if (auto *p = apvts.getRawParameterValue("lockSampleMemory"))
+    sampleManager.setLockSampleMemory(p->load() > 0.5f);
+
+  // Wavetable layer (choice 0 = Off, then WavetableBank::Waveform order)
+  int oscWaveIdx = 0;
+  if (auto *p = apvts.getRawParameterValue("oscWave"))
+    oscWaveIdx = (int)p->load();
+  auto *oscLevelParam = apvts.getRawParameterValue("oscLevel");
+  auto *oscOctaveParam = apvts.getRawParameterValue("oscOctave");
+  auto *sampleLevelParam = apvts.getRawParameterValue("sampleLevel");
+  synthEngine.updateOscillator(
+      oscWaveIdx - 1, oscLevelParam ? oscLevelParam->load() : 0.0f,
+      oscOctaveParam ? (int)oscOctaveParam->load() : 0,
+      sampleLevelParam ? sampleLevelParam->load() : 1.0f);
+
   // Apply parameters to effects processor
 
   float distDriveVal = distDrive ? distDrive->load() : 0.0f;
@@ -398,6 +607,15 @@ void HowlingWolvesAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
   distMixVal += (crushVal * 0.5f);
 
   float delayTimeVal = delayTime ? delayTime->load() : 0.5f;
+  if (auto *p = apvts.getRawParameterValue("delaySync")) {
+    // Note divisions in quarter notes: Off, 1/1, 1/2, 1/4, 1/4 D, 1/4 T, 1/8,
+    // 1/8 D, 1/8 T, 1/16
+    constexpr double delayBeats[] = {0.0,       4.0, 2.0,  1.0,       1.5,
+                                     2.0 / 3.0, 0.5, 0.75, 1.0 / 3.0, 0.25};
+    const int syncIdx = juce::jlimit(0, 9, (int)p->load());
+    if (syncIdx > 0 && currentBPM > 0.0f)
+      delayTimeVal = (float)(delayBeats[syncIdx] * 60.0 / currentBPM);
+  }
   float delayFdbkVal = delayFdbk ? delayFdbk->load() : 0.3f; // Default 0.3
   float delayMixVal = delayMix ? delayMix->load() : 0.0f;
   float revSizeVal = revSize ? revSize->load() : 0.5f;
@@ -428,50 +646,100 @@ void HowlingWolvesAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
                                     revDecayVal, revDampVal, revMixVal,
                                     biteVal);
 
-  // Update Toggles
-  auto *huntParam = apvts.getRawParameterValue("huntOn");
-  auto *bitcrushParam = apvts.getRawParameterValue("bitcrushOn");
-  if (huntParam)
+  {
+    auto *widthParam = apvts.getRawParameterValue("delayWidth");
+    auto *pingPongParam = apvts.getRawParameterValue("delayPingPong");
+    effectsProcessor.setDelayStereo(
+        widthParam ? widthParam->load() : 1.0f,
+        pingPongParam != nullptr && pingPongParam->load() > 0.5f);
+  }
+
+  if (auto *p = apvts.getRawParameterValue("reverbQuality"))
+    effectsProcessor.setReverbQuality((int)p->load());
+  if (auto *p = apvts.getRawParameterValue("fxWetRate"))
+    effectsProcessor.setWetPathRate((int)p->load());
+  {
+    auto *linkParam = apvts.getRawParameterValue("biteLink");
+    auto *lookaheadParam = apvts.getRawParameterValue("biteLookahead");
+    effectsProcessor.setTransientShaperMode(
+        linkParam == nullptr || linkParam->load() > 0.5f,
+        lookaheadParam != nullptr && lookaheadParam->load() > 0.5f);
+  }
+
+  // Same anti-aliasing for the distortion and the voices' filter drive
+  if (auto *p = apvts.getRawParameterValue("driveAntialias")) {
+    effectsProcessor.setDistortionAntialiasing((int)p->load());
+    synthEngine.setDriveAntialiasing((int)p->load());
+  }
+
+  {
+    auto *convMixParam = apvts.getRawParameterValue("convMix");
+    auto *convIRParam = apvts.getRawParameterValue("convIR");
+    effectsProcessor.setConvolution(convMixParam ? convMixParam->load() : 0.0f,
+                                    convIRParam ? (int)convIRParam->load() : 0);
+  }
+
+  // Update Toggles. The bitcrusher and the chain layout live in the effect
+  // graph, rebuilt on the message thread when their parameters change.
+  if (auto *huntParam = apvts.getRawParameterValue("huntOn"))
     effectsProcessor.setHuntEnabled((bool)huntParam->load());
-  if (bitcrushParam)
-    effectsProcessor.setBitcrushEnabled((bool)bitcrushParam->load());
-
-  // Update Chain Order
-  auto *chainOrderParam = apvts.getRawParameterValue("CHAIN_ORDER");
-  if (chainOrderParam) {
-    int mode = (int)chainOrderParam->load();
-    using ET = EffectsProcessor::EffectType;
-    std::array<ET, 4> order;
-
-    // Standard: Dist -> Bite -> Delay -> Reverb
-    // Ethereal: Reverb -> Delay -> Dist -> Bite
-    // Chaos: Delay -> Dist -> Bite -> Reverb
-    // Reverse: Reverb -> Delay -> Bite -> Dist
-
-    switch (mode) {
-    default:
-    case 0:
-      order = {ET::Distortion, ET::TransientShaper, ET::Delay, ET::Reverb};
-      break;
-    case 1:
-      order = {ET::Reverb, ET::Delay, ET::Distortion, ET::TransientShaper};
-      break;
-    case 2:
-      order = {ET::Delay, ET::Distortion, ET::TransientShaper, ET::Reverb};
-      break;
-    case 3:
-      order = {ET::Reverb, ET::Delay, ET::TransientShaper, ET::Distortion};
-      break;
-    }
-    effectsProcessor.setChainOrder(order);
+
+  // The oversampling filters, the shaper's lookahead and second-order
+  // anti-aliasing delay the whole output; keep the host's delay compensation
+  // in step when they change
+  if (auto *p = apvts.getRawParameterValue("fxOversampling"))
+    effectsProcessor.setOversampling((int)p->load());
+  if (effectsProcessor.getLatencySamples() != getLatencySamples())
+    setLatencySamples(effectsProcessor.getLatencySamples());
+
+  // --- Global LFO (computed once per block, read by every voice) ---
+  bool lfoGlobalOn = false;
+  if (auto *p = apvts.getRawParameterValue("lfoGlobal"))
+    lfoGlobalOn = p->load() > 0.5f;
+
+  if (lfoGlobalOn &&
+      globalLfoBuffer.getNumSamples() >= buffer.getNumSamples()) {
+    // Sync divisions in quarter notes: Free, 1 Bar, 1/2, 1/4, 1/8, 1/16
+    constexpr double syncBeats[] = {0.0, 4.0, 2.0, 1.0, 0.5, 0.25};
+    int syncIdx = 0;
+    if (auto *p = apvts.getRawParameterValue("lfoSync"))
+      syncIdx = juce::jlimit(0, 5, (int)p->load());
+    int waveIdx = 0;
+    if (auto *p = apvts.getRawParameterValue("lfoWave"))
+      waveIdx = juce::jlimit(0, 3, (int)p->load());
+
+    lfoProcessor.setWaveform((LFOProcessor::Waveform)waveIdx);
+    lfoProcessor.setRate(lfoRateParam ? lfoRateParam->load() : 1.0f);
+    lfoProcessor.setDepth(lfoDepthParam ? lfoDepthParam->load() : 0.0f);
+    lfoProcessor.setPhaseOffset(lfoPhaseParam ? lfoPhaseParam->load() : 0.0f);
+    lfoProcessor.setTempoSync(syncBeats[syncIdx]);
+
+    auto *lfoData = globalLfoBuffer.getWritePointer(0);
+    lfoProcessor.renderBlock(lfoData, buffer.getNumSamples(), playHead,
+                             currentBPM);
+    synthEngine.setGlobalLFO(lfoData);
+  } else {
+    synthEngine.setGlobalLFO(nullptr);
   }
 
-  // Process synth
-  synthEngine.renderNextBlock(buffer, midiMessages, 0, buffer.getNumSamples());
+  // Process synth. With no voices sounding and no MIDI there is nothing to
+  // render, and once the effect tails are done the whole block can sleep.
+  const bool synthAwake =
+      synthEngine.hasActiveVoices() || !midiMessages.isEmpty();
+  if (synthAwake)
+    synthEngine.renderNextBlock(buffer, midiMessages, 0,
+                                buffer.getNumSamples());
+
+  // The bank keeps ringing for a moment after the last voice stops
+  if (formantFilterOn && (synthAwake || !filterProcessor.isFormantIdle()))
+    filterProcessor.process(buffer);
 
   // Process effects
   effectsProcessor.process(buffer);
 
+  if (!synthAwake && effectsProcessor.isIdle())
+    return; // Still silent: skip the master section
+
   // --- Master Section (Gain / Pan) ---
   float gain = gainParam ? gainParam->load() : 0.5f;
   float pan = panParam ? panParam->load() : 0.0f;
@@ -538,6 +806,11 @@ HowlingWolvesAudioProcessor::createParameterLayout() {
                                                          1.0f, 0.0f));
   layout.add(std::make_unique<juce::AudioParameterFloat>("tune", "Tune", -12.0f,
                                                          12.0f, 0.0f));
+  layout.add(std::make_unique<juce::AudioParameterFloat>(
+      "glideTime", "Glide Time",
+      juce::NormalisableRange<float>(0.0f, 2.0f, 0.001f, 0.4f), 0.0f));
+  layout.add(std::make_unique<juce::AudioParameterInt>("bendRange",
+                                                       "Bend Range", 0, 24, 2));
 
   // Standalone helpers
   layout.add(std::make_unique<juce::AudioParameterFloat>(
@@ -552,11 +825,15 @@ HowlingWolvesAudioProcessor::createParameterLayout() {
                                                          0.0f, 1.0f, 1.0f));
   layout.add(std::make_unique<juce::AudioParameterFloat>("release", "Release",
                                                          0.01f, 5.0f, 0.1f));
+  layout.add(std::make_unique<juce::AudioParameterFloat>(
+      "ampCurve", "Amp Env Curve", 0.0f, 1.0f, 0.0f));
 
   // Filter parameters
   layout.add(std::make_unique<juce::AudioParameterChoice>(
       "filterType", "Filter Type",
-      juce::StringArray{"Low Pass", "High Pass", "Band Pass", "Notch"}, 0));
+      juce::StringArray{"Low Pass", "High Pass", "Band Pass", "Notch",
+                        "Formant"},
+      0));
   layout.add(std::make_unique<juce::AudioParameterFloat>(
       "filterCutoff", "Filter Cutoff",
       juce::NormalisableRange<float>(20.0f, 20000.0f, 1.0f, 0.3f), 1000.0f));
@@ -564,11 +841,14 @@ HowlingWolvesAudioProcessor::createParameterLayout() {
       "filterRes", "Filter Resonance", 0.0f, 1.0f, 0.5f));
   layout.add(std::make_unique<juce::AudioParameterFloat>(
       "filterDrive", "Filter Drive", 0.0f, 1.0f, 0.0f));
+  // Formant filter type: morphs A - E - I - O - U
+  layout.add(std::make_unique<juce::AudioParameterFloat>(
+      "filterVowel", "Filter Vowel", 0.0f, 1.0f, 0.0f));
 
   // LFO parameters
   layout.add(std::make_unique<juce::AudioParameterChoice>(
       "lfoWave", "LFO Waveform",
-      juce::StringArray{"Sine", "Square", "Triangle"}, 0));
+      juce::StringArray{"Sine", "Square", "Triangle", "Saw"}, 0));
   layout.add(std::make_unique<juce::AudioParameterFloat>("lfoRate", "LFO Rate",
                                                          0.01f, 20.0f, 1.0f));
   layout.add(std::make_unique<juce::AudioParameterChoice>(
@@ -577,6 +857,13 @@ HowlingWolvesAudioProcessor::createParameterLayout() {
   layout.add(std::make_unique<juce::AudioParameterFloat>(
       "lfoDepth", "LFO Depth", 0.0f, 1.0f, 0.5f));
 
+  // Global LFO: one shared, tempo-syncable LFO for all voices
+  layout.add(std::make_unique<juce::AudioParameterBool>("lfoGlobal",
+                                                        "LFO Global", false));
+  layout.add(std::make_unique<juce::AudioParameterChoice>(
+      "lfoSync", "LFO Sync",
+      juce::StringArray{"Free", "1 Bar", "1/2", "1/4", "1/8", "1/16"}, 0));
+
   // Modulation Envelope (Added for ModulateTab)
   layout.add(std::make_unique<juce::AudioParameterFloat>(
       "modAttack", "Mod Attack", 0.01f, 5.0f, 0.1f));
@@ -586,6 +873,8 @@ HowlingWolvesAudioProcessor::createParameterLayout() {
       "modSustain", "Mod Sustain", 0.0f, 1.0f, 1.0f));
   layout.add(std::make_unique<juce::AudioParameterFloat>(
       "modRelease", "Mod Release", 0.01f, 5.0f, 0.1f));
+  layout.add(std::make_unique<juce::AudioParameterFloat>(
+      "modCurve", "Mod Env Curve", 0.0f, 1.0f, 0.0f));
   layout.add(std::make_unique<juce::AudioParameterFloat>(
       "modAmount", "Mod Amount", 0.0f, 1.0f, 0.5f));
   layout.add(std::make_unique<juce::AudioParameterFloat>(
@@ -619,6 +908,44 @@ HowlingWolvesAudioProcessor::createParameterLayout() {
   layout.add(std::make_unique<juce::AudioParameterFloat>("ampPan", "Voice Pan",
                                                          -1.0f, 1.0f, 0.0f));
 
+  // Wavetable oscillator layer (sub/saw under the sample)
+  layout.add(std::make_unique<juce::AudioParameterChoice>(
+      "oscWave", "Osc Wave",
+      juce::StringArray{"Off", "Sine", "Saw", "Square", "Triangle"}, 0));
+  layout.add(std::make_unique<juce::AudioParameterFloat>(
+      "oscLevel", "Osc Level", 0.0f, 1.0f, 0.5f));
+  layout.add(std::make_unique<juce::AudioParameterInt>(
+      "oscOctave", "Osc Octave", -3, 2, -1));
+  layout.add(std::make_unique<juce::AudioParameterFloat>(
+      "sampleLevel", "Sample Level", 0.0f, 1.0f, 1.0f));
+
+  // Render low bass voices (MIDI 12..48, dark low-pass) at 1/2 or 1/4 rate
+  layout.add(std::make_unique<juce::AudioParameterBool>(
+      "bassMultiRate", "Bass Eco Render", false));
+
+  // Pin sample data, voices and engine scratch in RAM so playback can't
+  // page-fault (applies to the next sample load / prepareToPlay)
+  layout.add(std::make_unique<juce::AudioParameterBool>(
+      "lockSampleMemory", "Lock Sample Memory", false));
+
+  // Granular playback (textures always use it; grainMode forces it on)
+  layout.add(std::make_unique<juce::AudioParameterBool>("grainMode",
+                                                        "Granular", false));
+  layout.add(std::make_unique<juce::AudioParameterFloat>(
+      "grainSize", "Grain Size",
+      juce::NormalisableRange<float>(10.0f, 500.0f, 0.1f, 0.5f), 80.0f));
+  layout.add(std::make_unique<juce::AudioParameterFloat>(
+      "grainDensity", "Grain Density",
+      juce::NormalisableRange<float>(1.0f, 100.0f, 0.1f, 0.5f), 20.0f));
+  layout.add(std::make_unique<juce::AudioParameterFloat>(
+      "grainPosition", "Grain Position", 0.0f, 1.0f, 0.2f));
+  layout.add(std::make_unique<juce::AudioParameterFloat>(
+      "grainSpray", "Grain Spray", 0.0f, 1.0f, 0.1f));
+  layout.add(std::make_unique<juce::AudioParameterFloat>(
+      "grainPitch", "Grain Pitch", -24.0f, 24.0f, 0.0f));
+  layout.add(std::make_unique<juce::AudioParameterInt>(
+      "grainMaxGrains", "Max Grains", 1, GranularEngine::maxGrainsLimit, 16));
+
   // ... Effects ...
 
   // Distortion
@@ -627,6 +954,15 @@ HowlingWolvesAudioProcessor::createParameterLayout() {
   layout.add(std::make_unique<juce::AudioParameterFloat>(
       "distMix", "Distortion Mix", 0.0f, 1.0f,
       1.0f)); // Default 1.0 (Fully Audible)
+  // tanh anti-aliasing for the distortion and the voice filter drive
+  layout.add(std::make_unique<juce::AudioParameterChoice>(
+      "driveAntialias", "Drive Anti-Aliasing",
+      juce::StringArray{"Off", "ADAA 1st Order", "ADAA 2nd Order"}, 2));
+  layout.add(std::make_unique<juce::AudioParameterChoice>(
+      "fxOversampling", "Effects Oversampling",
+      juce::StringArray{"1x", "2x", "4x", "8x"}, 0));
+  layout.add(std::make_unique<juce::AudioParameterBool>(
+      "fxHelperThread", "Effects Helper Thread", true));
 
   // Toggles for Effects
   layout.add(
@@ -642,14 +978,17 @@ HowlingWolvesAudioProcessor::createParameterLayout() {
   layout.add(std::make_unique<juce::AudioParameterFloat>(
       "delayMix", "Delay Mix", 0.0f, 1.0f, 0.0f));
 
-  // Delay Width? EffectsTab: dWidthSlider "delayWidth".
-  // Note: I missed checking EffectsTab source manually for mismatches.
-  // Assuming defaults for now, but adding width just in case user mentioned it
-  // previously. Actually, EffectsTab.cpp from older logs might have it. Safest
-  // to add commonly used ones if unsure. I will check EffectsTab ID in next
-  // step if verification fails. For now, Proceed.
+  // Stereo width of the echoes (0 = mono, 1 = as is)
   layout.add(std::make_unique<juce::AudioParameterFloat>(
       "delayWidth", "Delay Width", 0.0f, 1.0f, 1.0f));
+  layout.add(std::make_unique<juce::AudioParameterBool>(
+      "delayPingPong", "Delay Ping-Pong", false));
+  // Off = free time from delayTime, otherwise a note division of the host BPM
+  layout.add(std::make_unique<juce::AudioParameterChoice>(
+      "delaySync", "Delay Sync",
+      juce::StringArray{"Off", "1/1", "1/2", "1/4", "1/4 D", "1/4 T", "1/8",
+                        "1/8 D", "1/8 T", "1/16"},
+      0));
 
   // Reverb
   layout.add(std::make_unique<juce::AudioParameterFloat>(
@@ -660,10 +999,33 @@ HowlingWolvesAudioProcessor::createParameterLayout() {
       "reverbDamping", "Reverb Damping", 0.0f, 1.0f, 0.5f));
   layout.add(std::make_unique<juce::AudioParameterFloat>(
       "REVERB_MIX", "Reverb Mix", 0.0f, 1.0f, 0.3f));
+  // FDN line count / modulation: trades density for CPU. Eco costs about
+  // what Freeverb did, Standard about 1.7x and High about 3x.
+  layout.add(std::make_unique<juce::AudioParameterChoice>(
+      "reverbQuality", "Reverb Quality",
+      juce::StringArray{"Eco", "Standard", "High"}, 1));
+  // Delay and FDN wet signals at a fraction of the rate: Half keeps the wet
+  // below 0.2x the sample rate, Quarter below 0.1x, for half or less the CPU
+  layout.add(std::make_unique<juce::AudioParameterChoice>(
+      "fxWetRate", "Delay/Reverb Wet Rate",
+      juce::StringArray{"Full", "Half", "Quarter"}, 0));
+
+  // Convolution reverb (after the FDN): long generated cave IRs
+  layout.add(std::make_unique<juce::AudioParameterFloat>(
+      "convMix", "Convolution Mix", 0.0f, 1.0f, 0.0f));
+  layout.add(std::make_unique<juce::AudioParameterChoice>(
+      "convIR", "Convolution Space",
+      juce::StringArray{"Cave", "Deep Cave", "Abyss"}, 0));
 
   // Transient Shaper
   layout.add(std::make_unique<juce::AudioParameterFloat>("BITE", "Bite Amount",
                                                          -1.0f, 1.0f, 0.0f));
+  // Link: one detector for both sides. Lookahead: the boost lands on the
+  // attack itself, for 2 ms of latency.
+  layout.add(std::make_unique<juce::AudioParameterBool>(
+      "biteLink", "Bite Stereo Link", true));
+  layout.add(std::make_unique<juce::AudioParameterBool>(
+      "biteLookahead", "Bite Lookahead", false));
 
   // --- MIDI Performance Parameters ---
   layout.add(std::make_unique<juce::AudioParameterBool>("arpEnabled", "Arp On",
@@ -698,6 +1060,11 @@ HowlingWolvesAudioProcessor::createParameterLayout() {
       "chordMode", "Chord Mode",
       juce::StringArray{"OFF", "Major", "Minor", "7th", "9th"}, 0));
 
+  // Duplicate chord/arp notes: off = merge into the sounding voice,
+  // on = retrigger it
+  layout.add(std::make_unique<juce::AudioParameterBool>(
+      "noteRetrigger", "Retrigger Duplicates", false));
+
   layout.add(std::make_unique<juce::AudioParameterChoice>(
       "HUNT_MODE", "Hunt Mode", juce::StringArray{"Stalk", "Chase", "Kill"},
       0));
@@ -705,7 +1072,19 @@ HowlingWolvesAudioProcessor::createParameterLayout() {
   // Signal Chain Order
   layout.add(std::make_unique<juce::AudioParameterChoice>(
       "CHAIN_ORDER", "Signal Chain",
-      juce::StringArray{"Standard", "Ethereal", "Chaos", "Reverse"}, 0));
+      juce::StringArray{"Standard", "Ethereal", "Chaos", "Reverse",
+                        "Parallel Sends"},
+      0));
+
+  // Per-effect bypass (the bitcrusher has its own on switch)
+  layout.add(std::make_unique<juce::AudioParameterBool>(
+      "distBypass", "Distortion Bypass", false));
+  layout.add(std::make_unique<juce::AudioParameterBool>(
+      "biteBypass", "Bite Bypass", false));
+  layout.add(std::make_unique<juce::AudioParameterBool>(
+      "delayBypass", "Delay Bypass", false));
+  layout.add(std::make_unique<juce::AudioParameterBool>(
+      "reverbBypass", "Reverb Bypass", false));
 
   return layout;
 }
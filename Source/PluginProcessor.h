@@ -9,11 +9,15 @@
 #include "MidiProcessor.h"
 #include "PresetManager.h"
 #include "SampleManager.h"
+#include "ScratchArena.h"
 #include "SynthEngine.h"
 #include <JuceHeader.h>
 #include <atomic>
 
-class HowlingWolvesAudioProcessor : public juce::AudioProcessor {
+class HowlingWolvesAudioProcessor
+    : public juce::AudioProcessor,
+      public juce::AudioProcessorValueTreeState::Listener,
+      private juce::AsyncUpdater {
 public:
   //==============================================================================
   HowlingWolvesAudioProcessor();
@@ -66,10 +70,14 @@ public:
   void setTransportPlaying(bool shouldPlay) { transportPlaying = shouldPlay; }
   bool isTransportPlaying() const { return transportPlaying; }
 
-  // Metering Accessors
-  float getEqLow() const { return effectsProcessor.eqLow; }
-  float getEqMid() const { return effectsProcessor.eqMid; }
-  float getEqHigh() const { return effectsProcessor.eqHigh; }
+  // Metering Accessors (UI thread; call updateMetering() once per frame)
+  void updateMetering() { effectsProcessor.getAnalyser().update(); }
+  float getEqLow() { return effectsProcessor.getAnalyser().getLow(); }
+  float getEqMid() { return effectsProcessor.getAnalyser().getMid(); }
+  float getEqHigh() { return effectsProcessor.getAnalyser().getHigh(); }
+  const std::array<float, OutputAnalyser::numSpectrumBands> &getSpectrum() {
+    return effectsProcessor.getAnalyser().getSpectrum();
+  }
 
   // License and Security
   LicenseManager &getLicenseManager() { return licenseManager; }
@@ -99,19 +107,54 @@ public:
   // which calls a hook if set.
   // std::function<void(const juce::AudioBuffer<float> &)> audioVisualizerHook;
 
+  // Effect graph parameters (layout and bypasses)
+  void parameterChanged(const juce::String &parameterID,
+                        float newValue) override;
+
 private:
   //==============================================================================
   juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
   juce::AudioProcessorValueTreeState apvts;
 
+  // The effect graph is built here on the message thread and handed over
+  static constexpr const char *effectGraphParameters[] = {
+      "CHAIN_ORDER",  "bitcrushOn",  "distBypass",    "biteBypass",
+      "delayBypass",  "reverbBypass", "fxHelperThread"};
+  void handleAsyncUpdate() override;
+  void rebuildEffectGraph();
+  EffectGraph publishedGraph; // Last layout sent to the effects
+
+  // Everything below processBlock is sized for the prepared block, so a
+  // longer host block is rendered in slices of at most that length
+  void processSubBlock(juce::AudioBuffer<float> &buffer,
+                       juce::MidiBuffer &midiMessages);
+  int preparedBlockSize = 0;
+  juce::MidiBuffer subBlockMidi;   // Input events of the current slice
+  juce::MidiBuffer hostBlockMidi;  // Output events gathered over the slices
+
+  // The host's position moved on to the start of the current slice, so the
+  // arpeggiator and synced LFO see the same timeline whatever the split
+  class SubBlockPlayHead : public juce::AudioPlayHead {
+  public:
+    juce::Optional<PositionInfo> getPosition() const override;
+
+    juce::AudioPlayHead *host = nullptr;
+    double sampleRate = 44100.0;
+    int offset = 0; // Samples into the host block
+  };
+  SubBlockPlayHead subBlockPlayHead;
+
   SampleManager sampleManager;
   SynthEngine synthEngine;
   juce::MidiKeyboardState keyboardState;
   PresetManager presetManager;
 
   // Filter and LFO
-  FilterProcessor filterProcessor;
+  FilterProcessor filterProcessor; // The Formant type, on the synth output
+  bool formantFilterOn = false;
   LFOProcessor lfoProcessor;
+  juce::AudioBuffer<float> globalLfoBuffer; // Shared LFO block read by voices
+  ScratchArena scratchArena; // Per-block temporaries for voices and effects
   EffectsProcessor effectsProcessor;
   MidiProcessor midiProcessor;
   HuntEngine huntEngine;
@@ -0,0 +1,105 @@
+#include "PolyphaseInterpolator.h"
+
+//==============================================================================
+// PolyphaseKernels
+//==============================================================================
+
+PolyphaseKernels::PolyphaseKernels() {
+  build(2, kernel2x.data());
+  build(4, kernel4x.data());
+}
+
+void PolyphaseKernels::build(int factor, float *dest) {
+  // Prototype low-pass at 0.9x the low-rate Nyquist, Blackman windowed
+  const int length = factor * tapsPerPhase;
+  const double cutoff = 0.45 / (double)factor; // Cycles per output sample
+  const double centre = 0.5 * (double)(length - 1);
+
+  std::vector<double> prototype((size_t)length);
+  for (int n = 0; n < length; ++n) {
+    const double x = (double)n - centre;
+    const double sinc =
+        (std::abs(x) < 1.0e-9)
+            ? 2.0 * cutoff
+            : std::sin(juce::MathConstants<double>::twoPi * cutoff * x) /
+                  (juce::MathConstants<double>::pi * x);
+    const double w = juce::MathConstants<double>::twoPi * (double)n /
+                     (double)(length - 1);
+    const double window = 0.42 - 0.5 * std::cos(w) + 0.08 * std::cos(2.0 * w);
+    prototype[(size_t)n] = sinc * window;
+  }
+
+  // Each phase should sum to 1 so DC passes at unity
+  for (int phase = 0; phase < factor; ++phase) {
+    double sum = 0.0;
+    for (int k = 0; k < tapsPerPhase; ++k)
+      sum += prototype[(size_t)(phase + k * factor)];
+
+    for (int k = 0; k < tapsPerPhase; ++k)
+      dest[phase * tapsPerPhase + k] =
+          (float)(prototype[(size_t)(phase + k * factor)] /
+                  (sum != 0.0 ? sum : 1.0));
+  }
+}
+
+const float *PolyphaseKernels::getPhase(int factor, int phase) const {
+  if (factor == 4)
+    return kernel4x.data() + phase * tapsPerPhase;
+  return kernel2x.data() + phase * tapsPerPhase;
+}
+
+//==============================================================================
+// PolyphaseInterpolator
+//==============================================================================
+
+void PolyphaseInterpolator::setFactor(int newFactor) {
+  factor = (newFactor == 2 || newFactor == 4) ? newFactor : 1;
+  reset();
+}
+
+void PolyphaseInterpolator::reset() {
+  history.fill(0.0f);
+  subPhase = 0;
+  writePos = 0;
+}
+
+int PolyphaseInterpolator::getNumInputSamplesNeeded(
+    int numOutputSamples) const {
+  if (factor <= 1)
+    return numOutputSamples;
+
+  // A new input sample is consumed whenever the sub-phase wraps to zero
+  const int firstConsume = (factor - subPhase) % factor;
+  if (firstConsume >= numOutputSamples)
+    return 0;
+  return (numOutputSamples - 1 - firstConsume) / factor + 1;
+}
+
+void PolyphaseInterpolator::process(const float *input, float *output,
+                                    int numOutputSamples) {
+  if (factor <= 1) {
+    juce::FloatVectorOperations::copy(output, input, numOutputSamples);
+    return;
+  }
+
+  int inputIndex = 0;
+  for (int i = 0; i < numOutputSamples; ++i) {
+    if (subPhase == 0) {
+      writePos = (writePos + taps - 1) % taps;
+      history[(size_t)writePos] = input[inputIndex];
+      history[(size_t)(writePos + taps)] = input[inputIndex];
+      ++inputIndex;
+    }
+
+    const float *h = kernels->getPhase(factor, subPhase);
+    const float *x = history.data() + writePos;
+
+    float acc = 0.0f;
+    for (int k = 0; k < taps; ++k)
+      acc += h[k] * x[k];
+    output[i] = acc;
+
+    if (++subPhase == factor)
+      subPhase = 0;
+  }
+}
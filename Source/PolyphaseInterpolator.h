@@ -0,0 +1,59 @@
+#pragma once
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Windowed-sinc kernels for 2x and 4x interpolation, stored phase-major so
+    each output sample reads one contiguous run of taps. Built once and
+    shared by every voice.
+*/
+class PolyphaseKernels {
+public:
+  static constexpr int tapsPerPhase = 8;
+  static constexpr int maxFactor = 4;
+
+  PolyphaseKernels();
+
+  // Taps for the given phase of a 2x or 4x kernel
+  const float *getPhase(int factor, int phase) const;
+
+private:
+  void build(int factor, float *dest);
+
+  std::array<float, 2 * tapsPerPhase> kernel2x{};
+  std::array<float, 4 * tapsPerPhase> kernel4x{};
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PolyphaseKernels)
+};
+
+//==============================================================================
+/**
+    Streaming polyphase upsampler used by voices that render at 1/2 or 1/4 of
+    the host rate. Works on arbitrary block sizes: it keeps its sub-phase
+    between calls and tells the caller how many low-rate samples to render.
+*/
+class PolyphaseInterpolator {
+public:
+  PolyphaseInterpolator() = default;
+
+  void setFactor(int newFactor); // 1, 2 or 4 (resets state)
+  int getFactor() const { return factor; }
+  void reset();
+
+  // Low-rate samples that process() will consume for numOutputSamples
+  int getNumInputSamplesNeeded(int numOutputSamples) const;
+
+  void process(const float *input, float *output, int numOutputSamples);
+
+private:
+  juce::SharedResourcePointer<PolyphaseKernels> kernels;
+
+  static constexpr int taps = PolyphaseKernels::tapsPerPhase;
+
+  int factor = 1;
+  int subPhase = 0;
+  int writePos = 0;
+  std::array<float, 2 * taps> history{}; // Doubled ring for contiguous reads
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PolyphaseInterpolator)
+};
@@ -0,0 +1,74 @@
+#include "RealtimeWorker.h"
+
+//==============================================================================
+RealtimeWorker::RealtimeWorker() : juce::Thread("Effects Helper") {}
+
+RealtimeWorker::~RealtimeWorker() { stop(); }
+
+void RealtimeWorker::start(double blockPeriodMs) {
+  stop();
+
+  // Still waiting half a block after finishing its own share, the audio
+  // thread would have been better off running the job itself
+  deadlineTicks = juce::Time::secondsToHighResolutionTicks(
+      0.5 * blockPeriodMs / 1000.0);
+
+  // A normal-priority helper can be descheduled mid-job with the audio
+  // thread waiting on it, so without real-time scheduling there is none
+  if (startRealtimeThread(
+          juce::Thread::RealtimeOptions{}.withPeriodMs(blockPeriodMs)))
+    available.store(true, std::memory_order_release);
+}
+
+void RealtimeWorker::stop() {
+  available.store(false, std::memory_order_release);
+  signalThreadShouldExit();
+  wakeUp.signal();
+  stopThread(4000);
+}
+
+void RealtimeWorker::post(Job &jobToRun) {
+  jassert(state.load() == idle);
+  job.store(&jobToRun, std::memory_order_relaxed);
+  state.store(posted, std::memory_order_release);
+  wakeUp.signal();
+}
+
+bool RealtimeWorker::claim() {
+  int expected = posted;
+  return state.compare_exchange_strong(expected, running,
+                                       std::memory_order_acq_rel);
+}
+
+void RealtimeWorker::join() {
+  if (claim()) {
+    // The helper hasn't got to it: cheaper to run it than to wait
+    job.load(std::memory_order_relaxed)->run();
+  } else {
+    const auto deadline = juce::Time::getHighResolutionTicks() + deadlineTicks;
+    bool late = false;
+    while (state.load(std::memory_order_acquire) != done) {
+      if (late) {
+        juce::Thread::yield(); // Give a descheduled helper the core
+      } else if (juce::Time::getHighResolutionTicks() > deadline) {
+        late = true;
+        available.store(false, std::memory_order_release);
+      }
+    }
+  }
+  state.store(idle, std::memory_order_relaxed);
+}
+
+void RealtimeWorker::run() {
+  for (;;) {
+    wakeUp.wait();
+    if (threadShouldExit())
+      break;
+
+    if (claim()) {
+      juce::ScopedNoDenormals noDenormals;
+      job.load(std::memory_order_relaxed)->run();
+      state.store(done, std::memory_order_release);
+    }
+  }
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include "LightweightSemaphore.h"
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    A real-time helper thread that takes one job per audio callback.
+
+    The audio thread posts a job, carries on with its own share of the work
+    and then joins. If the helper hasn't picked the job up by then (it may
+    not have been scheduled yet), the audio thread claims it and runs it
+    itself, so a late helper never costs more than running serially.
+
+    A job the helper has started can't be taken back, so join() waits for
+    it: spinning up to a deadline, then yielding. A helper that overruns the
+    deadline is retired and every later job runs on the audio thread until
+    the worker is restarted. The helper only starts with real-time
+    scheduling; where that isn't allowed the worker stays unavailable.
+
+    Nothing here allocates or locks on the audio thread: posting is an
+    atomic add, plus a kernel wake-up (a futex on Linux) when the helper is
+    asleep.
+*/
+class RealtimeWorker : private juce::Thread {
+public:
+  class Job {
+  public:
+    virtual ~Job() = default;
+    virtual void run() = 0;
+  };
+
+  RealtimeWorker();
+  ~RealtimeWorker() override;
+
+  // Message thread. The period hints the scheduler about the callback rate
+  // and sets the join deadline.
+  void start(double blockPeriodMs);
+  void stop();
+  bool isStarted() const { return isThreadRunning(); }
+
+  // --- Audio thread ---
+  // Whether posting is worthwhile: started, real-time and never late
+  bool isAvailable() const {
+    return available.load(std::memory_order_acquire);
+  }
+
+  // Hands the job over. The job must stay alive until join() returns.
+  void post(Job &job);
+
+  // Returns once the posted job has run, here or on the helper
+  void join();
+
+private:
+  enum State { idle, posted, running, done };
+
+  void run() override;
+  bool claim(); // posted -> running, by whichever thread gets there first
+
+  LightweightSemaphore wakeUp;
+  std::atomic<Job *> job{nullptr};
+  std::atomic<int> state{idle};
+  std::atomic<bool> available{false};
+  juce::int64 deadlineTicks = 0;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RealtimeWorker)
+};
@@ -4,13 +4,88 @@ SampleManager::SampleManager(SynthEngine &s) : synthEngine(s) {
   formatManager.registerBasicFormats();
 }
 
-SampleManager::~SampleManager() {}
+SampleManager::~SampleManager() { stopTimer(); }
+
+void SampleManager::retireSounds() {
+  padSounds = {};
+
+  const juce::ScopedLock sl(retiredLock);
+  for (int i = 0; i < synthEngine.getNumSounds(); ++i)
+    retiredSounds.push_back(synthEngine.getSound(i));
+  synthEngine.clearSounds();
+
+  if (!retiredSounds.empty())
+    startTimer(250);
+}
+
+void SampleManager::timerCallback() {
+  const juce::ScopedLock sl(retiredLock);
+
+  // Out of the synth, so no voice can pick one up again: a count of one is
+  // this list alone
+  retiredSounds.erase(
+      std::remove_if(retiredSounds.begin(), retiredSounds.end(),
+                     [](const juce::SynthesiserSound::Ptr &sound) {
+                       return sound->getReferenceCount() == 1;
+                     }),
+      retiredSounds.end());
+
+  if (retiredSounds.empty())
+    stopTimer();
+}
+
+// Whether a file name has a hi-hat word in it. Names are split into words
+// at separators, digits and lower-to-upper case changes ("ClosedHat_02" ->
+// Closed, Hat), so "Phat Kick" or "Chat Vox" don't count.
+static bool isHiHatName(const juce::String &name) {
+  static const juce::StringArray hatWords{"hat", "hats", "hihat", "hihats",
+                                          "hh",  "oh",   "ch",    "ohh",
+                                          "chh"};
+  juce::String word;
+  auto isHatWord = [&] {
+    return word.isNotEmpty() && hatWords.contains(word, true);
+  };
+
+  juce::juce_wchar previous = 0;
+  for (int i = 0; i < name.length(); ++i) {
+    const auto c = name[i];
+    const bool letter = juce::CharacterFunctions::isLetter(c);
+    const bool startsWord =
+        !letter || juce::CharacterFunctions::isLetter(previous) != letter ||
+        (juce::CharacterFunctions::isLowerCase(previous) &&
+         juce::CharacterFunctions::isUpperCase(c));
+
+    if (startsWord) {
+      if (isHatWord())
+        return true;
+      word.clear();
+    }
+    if (letter)
+      word += juce::String::charToString(c);
+    previous = c;
+  }
+  return isHatWord();
+}
+
+// One-shot drum hits: cap how many hits can ring at once, and let hi-hats
+// (open/closed) cut each other off unless the pad says otherwise
+static void applyDrumVoicing(HowlingSound &sound, const juce::String &name,
+                             const SampleManager::PadVoicing &voicing) {
+  constexpr int hatChokeGroup = 1;
+
+  sound.setMaxVoices(voicing.maxVoices);
+
+  if (voicing.chokeGroup != SampleManager::autoChokeGroup)
+    sound.setChokeGroup(voicing.chokeGroup);
+  else
+    sound.setChokeGroup(isHiHatName(name) ? hatChokeGroup : 0);
+}
 
 // Helper to get standard location with priority search
 void SampleManager::loadSamples() {
   // Initial load can be left empty or load a default welcome sound.
   // We rely on the user selecting a preset.
-  synthEngine.clearSounds();
+  retireSounds();
 }
 
 void SampleManager::loadSound(const juce::File &file) {
@@ -18,7 +93,7 @@ void SampleManager::loadSound(const juce::File &file) {
     return;
 
   // Clear current sounds first so we don't play the old one if this load fails
-  synthEngine.clearSounds();
+  retireSounds();
   currentSamplePath = file.getFullPathName();
 
   std::unique_ptr<juce::AudioFormatReader> reader(
@@ -36,8 +111,8 @@ void SampleManager::loadSound(const juce::File &file) {
     bool isPluck = folder.equalsIgnoreCase("Plucks");
     bool isBass = folder.equalsIgnoreCase("Bass");
     bool isFX = folder.equalsIgnoreCase("FX");
-    bool isTexture = false; // folder.containsIgnoreCase("Texture"); // Removed
-                            // per user request
+    // Textures now play through the granular engine instead of plain looping
+    bool isTexture = folder.containsIgnoreCase("Texture");
     bool isSequence = folder.containsIgnoreCase("Sequence");
     bool isDrum = folder.containsIgnoreCase("Drum");
 
@@ -141,8 +216,13 @@ void SampleManager::loadSound(const juce::File &file) {
 
     auto *sound =
         new HowlingSound(file.getFileNameWithoutExtension(), *reader, allNotes,
-                         rootNote, 0.0, 100.0, 60.0, isBass, isOneShot);
+                         rootNote, 0.0, 100.0, 60.0, isBass, isOneShot,
+                         isTexture);
+
+    if (isDrum)
+      applyDrumVoicing(*sound, file.getFileNameWithoutExtension(), {});
 
+    sound->prepareSampleMemory(lockSampleMemory);
     synthEngine.addSound(sound);
   } else {
     DBG("Failed to load sample: " + file.getFullPathName());
@@ -156,7 +236,7 @@ void SampleManager::loadDrumKit(const juce::File &kitDirectory) {
     return;
 
   // Clear current sounds first so we don't play the old one if this load fails
-  synthEngine.clearSounds();
+  retireSounds();
 
   auto allowedExtensions = formatManager.getWildcardForAllFormats();
   int midiNote = 36; // Start at C1 (Standard Drum Map)
@@ -166,7 +246,7 @@ void SampleManager::loadDrumKit(const juce::File &kitDirectory) {
   for (const auto &file : kitDirectory.findChildFiles(
            juce::File::findFiles, false, allowedExtensions)) {
 
-    if (count >= 16)
+    if (count >= numPads)
       break; // Limit to 16 pads
 
     std::unique_ptr<juce::AudioFormatReader> reader(
@@ -187,8 +267,11 @@ void SampleManager::loadDrumKit(const juce::File &kitDirectory) {
                            midiNote,       // Root note = played note
                            0.0, 0.1, 60.0, // Fast attack
                            false, true);   // isBass=false, isOneShot=true
+      applyDrumVoicing(*sound, file.getFileNameWithoutExtension(),
+                       padVoicing[(size_t)count]);
 
-      synthEngine.addSound(sound);
+      sound->prepareSampleMemory(lockSampleMemory);
+      padSounds[(size_t)count] = synthEngine.addSound(sound);
       midiNote++;
       count++;
     }
@@ -198,3 +281,19 @@ void SampleManager::loadDrumKit(const juce::File &kitDirectory) {
 juce::String SampleManager::getCurrentSamplePath() const {
   return currentSamplePath;
 }
+
+void SampleManager::setPadVoicing(int pad, PadVoicing voicing) {
+  if (!juce::isPositiveAndBelow(pad, numPads))
+    return;
+
+  padVoicing[(size_t)pad] = voicing;
+  if (auto *sound =
+          dynamic_cast<HowlingSound *>(padSounds[(size_t)pad].get()))
+    applyDrumVoicing(*sound, sound->getName(), voicing);
+}
+
+SampleManager::PadVoicing SampleManager::getPadVoicing(int pad) const {
+  if (!juce::isPositiveAndBelow(pad, numPads))
+    return {};
+  return padVoicing[(size_t)pad];
+}
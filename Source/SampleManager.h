@@ -7,7 +7,7 @@
 /**
     Manages loading of samples and mapping them to the synth.
 */
-class SampleManager : public juce::ChangeBroadcaster {
+class SampleManager : public juce::ChangeBroadcaster, private juce::Timer {
 public:
   SampleManager(SynthEngine &synth);
   ~SampleManager();
@@ -18,8 +18,38 @@ public:
 
   juce::String getCurrentSamplePath() const;
 
+  // Drum kit pads (0..15, notes 36..51): how many hits of a pad ring at
+  // once and which pads cut each other off. Changes apply to the loaded kit
+  // straight away and carry over to the next one.
+  static constexpr int numPads = 16;
+  static constexpr int autoChokeGroup = -1; // Hi-hats share group 1
+  struct PadVoicing {
+    int chokeGroup = autoChokeGroup; // 0 = none
+    int maxVoices = 2;               // 0 = unlimited
+  };
+  void setPadVoicing(int pad, PadVoicing voicing);
+  PadVoicing getPadVoicing(int pad) const;
+
+  // Pin newly loaded sample data in RAM (applies from the next load). Sample
+  // pages are always pre-faulted either way.
+  void setLockSampleMemory(bool shouldLock) { lockSampleMemory = shouldLock; }
+
 private:
+  // Takes every sound out of the synth. A voice may still be playing one,
+  // and whoever drops the last reference frees the sample data and unlocks
+  // its pages, so the sounds are kept here until the voices let go and then
+  // released by the timer on the message thread, never by a voice.
+  void retireSounds();
+  void timerCallback() override;
+
   SynthEngine &synthEngine;
   juce::AudioFormatManager formatManager;
   juce::String currentSamplePath;
+  std::atomic<bool> lockSampleMemory{false};
+
+  std::array<PadVoicing, numPads> padVoicing;
+  std::array<juce::SynthesiserSound::Ptr, numPads> padSounds;
+
+  juce::CriticalSection retiredLock; // Loads may come off the message thread
+  std::vector<juce::SynthesiserSound::Ptr> retiredSounds;
 };
@@ -0,0 +1,55 @@
+#include "ScratchArena.h"
+
+void ScratchArena::prepare(size_t capacityInFloats, bool lockMemory) {
+  lockedStorage = {};
+
+  // Round up to whole cache lines so every allocation stays aligned
+  capacity = (capacityInFloats + floatsPerLine - 1) / floatsPerLine *
+             floatsPerLine;
+
+  storage.calloc(capacity + floatsPerLine);
+
+  const auto address = reinterpret_cast<std::uintptr_t>(storage.get());
+  const auto misalignment = address % alignment;
+  base = storage.get() +
+         (misalignment == 0 ? 0 : (alignment - misalignment) / sizeof(float));
+
+  // calloc can hand back untouched zero pages; write them now instead of on
+  // the audio thread's first big block
+  const size_t totalFloats = capacity + floatsPerLine;
+  std::fill(storage.get(), storage.get() + totalFloats, 0.0f);
+
+  if (lockMemory)
+    lockedStorage =
+        LockedMemoryRegion(storage.get(), totalFloats * sizeof(float));
+
+  used = 0;
+  highWaterMark = 0;
+}
+
+float *ScratchArena::allocate(int numFloats) {
+  const auto size = ((size_t)juce::jmax(numFloats, 1) + floatsPerLine - 1) /
+                    floatsPerLine * floatsPerLine;
+
+  if (used + size > capacity) {
+    // Not sized for this block: check the numbers passed to prepare()
+    jassertfalse;
+    return nullptr;
+  }
+
+  auto *block = base + used;
+  used += size;
+  highWaterMark = juce::jmax(highWaterMark, used);
+  return block;
+}
+
+bool ScratchArena::allocateChannels(float **channelPointers, int numChannels,
+                                    int numSamples) {
+  for (int ch = 0; ch < numChannels; ++ch) {
+    channelPointers[ch] = allocate(numSamples);
+    if (channelPointers[ch] == nullptr)
+      return false;
+  }
+
+  return true;
+}
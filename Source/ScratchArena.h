@@ -0,0 +1,63 @@
+#pragma once
+#include "LockedMemoryRegion.h"
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Engine-wide scratch memory for per-block temporaries.
+
+    One 64-byte-aligned slab is allocated in prepareToPlay; the audio thread
+    only bumps an offset through it, so scratch requests can never allocate.
+    Use a Scope to hand memory back when a stage is done with it: voices are
+    rendered one after another, so they all reuse the same region.
+*/
+class ScratchArena {
+public:
+  static constexpr size_t alignment = 64;
+
+  ScratchArena() = default;
+
+  // Message thread only. The slab is always pre-faulted; lockMemory also pins
+  // it in RAM.
+  void prepare(size_t capacityInFloats, bool lockMemory = false);
+
+  // Returns 64-byte-aligned, uninitialised memory, or nullptr (and asserts)
+  // if the arena is exhausted
+  float *allocate(int numFloats);
+
+  // Fills channelPointers with numChannels aligned channels. Returns false if
+  // the arena is exhausted.
+  bool allocateChannels(float **channelPointers, int numChannels,
+                        int numSamples);
+
+  void reset() { used = 0; }
+
+  size_t getCapacity() const { return capacity; }
+  size_t getHighWaterMark() const { return highWaterMark; }
+
+  //==============================================================================
+  /** Rewinds the arena to where it was when the scope was opened. */
+  class Scope {
+  public:
+    explicit Scope(ScratchArena &a) : arena(a), mark(a.used) {}
+    ~Scope() { arena.used = mark; }
+
+  private:
+    ScratchArena &arena;
+    const size_t mark;
+
+    JUCE_DECLARE_NON_COPYABLE(Scope)
+  };
+
+private:
+  static constexpr size_t floatsPerLine = alignment / sizeof(float);
+
+  juce::HeapBlock<float> storage;
+  float *base = nullptr; // First aligned float in storage
+  size_t capacity = 0;   // In floats
+  size_t used = 0;
+  size_t highWaterMark = 0;
+  LockedMemoryRegion lockedStorage;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ScratchArena)
+};
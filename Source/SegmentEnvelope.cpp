@@ -0,0 +1,195 @@
+#include "SegmentEnvelope.h"
+
+void SegmentEnvelope::setSampleRate(double newSampleRate) {
+  if (newSampleRate > 0.0)
+    sampleRate = newSampleRate;
+}
+
+void SegmentEnvelope::setParameters(const Parameters &newParameters) {
+  parameters = newParameters;
+  parameters.sustain = juce::jlimit(0.0f, 1.0f, parameters.sustain);
+
+  // Like juce::ADSR, a sustain change applies straight away while sustaining
+  if (stage == Stage::Sustain)
+    value = parameters.sustain;
+}
+
+void SegmentEnvelope::noteOn() {
+  if (parameters.attack > 0.0f) {
+    // Retriggers continue from the current level at the same slope
+    startSegment(Stage::Attack, 1.0f, parameters.attack * (1.0f - value),
+                 parameters.attackCurve);
+  } else {
+    value = 1.0f;
+    advanceStage();
+  }
+}
+
+void SegmentEnvelope::noteOff() {
+  if (stage == Stage::Idle)
+    return;
+
+  if (parameters.release > 0.0f)
+    startSegment(Stage::Release, 0.0f, parameters.release,
+                 parameters.releaseCurve);
+  else
+    reset();
+}
+
+void SegmentEnvelope::reset() {
+  stage = Stage::Idle;
+  value = 0.0f;
+  samplesLeft = 0;
+}
+
+void SegmentEnvelope::startSegment(Stage newStage, float endValue,
+                                   double lengthSeconds, float curve) {
+  stage = newStage;
+  segmentEnd = endValue;
+  samplesLeft = juce::jmax(1, (int)std::round(lengthSeconds * sampleRate));
+
+  const float distance = endValue - value;
+
+  if (curve < 0.01f || std::abs(distance) < 1.0e-6f) {
+    multiplier = 1.0f;
+    increment = distance / (float)samplesLeft;
+    return;
+  }
+
+  // Aim past the end point by a ratio r so the curve lands on endValue after
+  // exactly samplesLeft samples: c^N = r / (1 + r)
+  const double ratio = std::exp(-7.0 * (double)juce::jmin(curve, 1.0f));
+  target = endValue + (float)ratio * distance;
+  multiplier =
+      (float)std::pow(ratio / (1.0 + ratio), 1.0 / (double)samplesLeft);
+  increment = 0.0f;
+}
+
+void SegmentEnvelope::advanceStage() {
+  switch (stage) {
+  case Stage::Idle:
+  case Stage::Attack:
+    value = 1.0f;
+    if (parameters.decay > 0.0f && parameters.sustain < 1.0f) {
+      startSegment(Stage::Decay, parameters.sustain, parameters.decay,
+                   parameters.decayCurve);
+    } else {
+      value = parameters.sustain;
+      stage = Stage::Sustain;
+    }
+    break;
+
+  case Stage::Decay:
+    value = parameters.sustain;
+    stage = Stage::Sustain;
+    break;
+
+  case Stage::Sustain:
+    break;
+
+  case Stage::Release:
+    reset();
+    break;
+  }
+}
+
+void SegmentEnvelope::fillRun(float *dest, int numSamples, float start,
+                              float target, float multiplier,
+                              float increment) {
+  constexpr int lanes = 4;
+  int i = 0;
+
+  if (multiplier == 1.0f) {
+    // Linear: lane k starts at start + k * inc, then every lane steps 4 * inc
+    float lane[lanes];
+    for (int k = 0; k < lanes; ++k)
+      lane[k] = start + (float)k * increment;
+    const float stride = increment * (float)lanes;
+
+    for (; i + lanes <= numSamples; i += lanes) {
+      for (int k = 0; k < lanes; ++k) {
+        dest[i + k] = lane[k];
+        lane[k] += stride;
+      }
+    }
+
+    for (int k = 0; i < numSamples; ++i, ++k)
+      dest[i] = lane[k];
+  } else {
+    // Exponential: offsets from the target shrink by c^4 per stride
+    float lane[lanes];
+    float offset = start - target;
+    for (int k = 0; k < lanes; ++k) {
+      lane[k] = offset;
+      offset *= multiplier;
+    }
+    const float c2 = multiplier * multiplier;
+    const float stride = c2 * c2; // c^4
+
+    for (; i + lanes <= numSamples; i += lanes) {
+      for (int k = 0; k < lanes; ++k) {
+        dest[i + k] = target + lane[k];
+        lane[k] *= stride;
+      }
+    }
+
+    for (int k = 0; i < numSamples; ++i, ++k)
+      dest[i] = target + lane[k];
+  }
+}
+
+void SegmentEnvelope::render(float *dest, int numSamples) {
+  int done = 0;
+
+  while (done < numSamples) {
+    const int remaining = numSamples - done;
+
+    if (stage == Stage::Idle || stage == Stage::Sustain) {
+      juce::FloatVectorOperations::fill(dest + done, value, remaining);
+      return;
+    }
+
+    const int run = juce::jmin(remaining, samplesLeft);
+    fillRun(dest + done, run, value, target, multiplier, increment);
+
+    samplesLeft -= run;
+    done += run;
+
+    if (samplesLeft <= 0) {
+      // Land exactly on the segment end and move on
+      value = segmentEnd;
+      advanceStage();
+    } else if (multiplier == 1.0f) {
+      value += increment * (float)run;
+    } else {
+      value = target +
+              (value - target) * (float)std::pow((double)multiplier, run);
+    }
+  }
+}
+
+void SegmentEnvelope::applyEnvelopeToBuffer(juce::AudioBuffer<float> &buffer,
+                                            int startSample, int numSamples) {
+  // Small stack chunk keeps this allocation-free for any block size
+  constexpr int chunkSize = 64;
+  float env[chunkSize];
+  const int numChannels = buffer.getNumChannels();
+
+  while (numSamples > 0) {
+    const int n = juce::jmin(chunkSize, numSamples);
+    render(env, n);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+      juce::FloatVectorOperations::multiply(
+          buffer.getWritePointer(ch, startSample), env, n);
+
+    startSample += n;
+    numSamples -= n;
+  }
+}
+
+float SegmentEnvelope::getNextSample() {
+  float out;
+  render(&out, 1);
+  return out;
+}
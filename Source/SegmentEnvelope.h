@@ -0,0 +1,73 @@
+#pragma once
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    ADSR envelope that renders whole segment runs per block.
+
+    Every segment is y[n] = T + (y0 - T) * c^n (c = 1 gives a linear ramp),
+    so the length of each segment is known when it starts. A block is filled
+    by walking segment boundaries analytically, making the control logic cost
+    O(segments) rather than O(samples). Runs are filled four lanes at a time.
+
+    Drop-in for the juce::ADSR calls HowlingVoice makes.
+*/
+class SegmentEnvelope {
+public:
+  struct Parameters {
+    float attack = 0.1f;
+    float decay = 0.1f;
+    float sustain = 1.0f;
+    float release = 0.1f;
+
+    // 0 = linear, 1 = strongly exponential
+    float attackCurve = 0.0f;
+    float decayCurve = 0.0f;
+    float releaseCurve = 0.0f;
+  };
+
+  SegmentEnvelope() = default;
+
+  void setSampleRate(double newSampleRate);
+  void setParameters(const Parameters &newParameters);
+  const Parameters &getParameters() const { return parameters; }
+
+  void noteOn();
+  void noteOff();
+  void reset();
+
+  bool isActive() const { return stage != Stage::Idle; }
+
+  // Fills dest with the next numSamples envelope values
+  void render(float *dest, int numSamples);
+
+  // Multiplies every channel of buffer by the envelope
+  void applyEnvelopeToBuffer(juce::AudioBuffer<float> &buffer, int startSample,
+                             int numSamples);
+
+  float getNextSample();
+
+private:
+  enum class Stage { Idle, Attack, Decay, Sustain, Release };
+
+  void startSegment(Stage newStage, float endValue, double lengthSeconds,
+                    float curve);
+  void advanceStage();
+  static void fillRun(float *dest, int numSamples, float start, float target,
+                      float multiplier, float increment);
+
+  Parameters parameters;
+  double sampleRate = 44100.0;
+
+  Stage stage = Stage::Idle;
+  float value = 0.0f;
+
+  // Current segment
+  int samplesLeft = 0;
+  float segmentEnd = 0.0f;
+  float multiplier = 1.0f; // c
+  float target = 0.0f;     // T (only used when c != 1)
+  float increment = 0.0f;  // Per-sample step when linear
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SegmentEnvelope)
+};
@@ -0,0 +1,281 @@
+#include "StereoDelay.h"
+
+void StereoDelay::prepare(const juce::dsp::ProcessSpec &spec,
+                          ScratchArena &scratchArena) {
+  preparedRate = spec.sampleRate;
+  maxBlockSize = (int)spec.maximumBlockSize;
+  scratch = &scratchArena;
+
+  // Sized for the full rate, whatever the divisor
+  const int ringSize = juce::nextPowerOfTwo(
+      (int)std::ceil(maxDelaySeconds * preparedRate) + maxBlockSize + 1);
+  for (auto &line : ring)
+    line.assign((size_t)ringSize, 0.0f);
+  ringMask = ringSize - 1;
+
+  updateRate();
+}
+
+void StereoDelay::setRateDivisor(int divisor) {
+  divisor = juce::jlimit(1, 4, divisor);
+  if (divisor == rateDivisor)
+    return;
+
+  rateDivisor = divisor;
+  updateRate();
+}
+
+void StereoDelay::updateRate() {
+  sampleRate = preparedRate / rateDivisor;
+  fadeLength = juce::jmax(1, (int)(crossfadeSeconds * sampleRate));
+
+  feedbackParam.reset(sampleRate, 0.05);
+  mixParam.reset(sampleRate, 0.05);
+  widthParam.reset(sampleRate, 0.05);
+
+  updateTargetDelay();
+  reset();
+}
+
+void StereoDelay::reset() {
+  written = 0;
+  currentDelay = nextDelay = targetDelay;
+  fading = false;
+  fadePos = 0;
+  tailSamples = 0;
+}
+
+void StereoDelay::setParameters(float newTimeSeconds, float feedback,
+                                float mix) {
+  timeSeconds = newTimeSeconds;
+  updateTargetDelay();
+
+  feedbackParam.setTargetValue(juce::jlimit(0.0f, 0.99f, feedback));
+  mixParam.setTargetValue(juce::jlimit(0.0f, 1.0f, mix));
+}
+
+void StereoDelay::updateTargetDelay() {
+  // 1 ms floor keeps the feedback runs from collapsing to single samples
+  const int minDelay = juce::jmax(1, (int)(0.001 * sampleRate));
+  const int maxDelay = (int)(maxDelaySeconds * sampleRate);
+  targetDelay = juce::jlimit(minDelay, maxDelay,
+                             (int)std::lround(timeSeconds * sampleRate));
+}
+
+void StereoDelay::setStereo(float width, bool pingPong) {
+  widthParam.setTargetValue(juce::jlimit(0.0f, 1.0f, width));
+  pingPongEnabled = pingPong;
+}
+
+void StereoDelay::skip(int numSamples) {
+  feedbackParam.skip(numSamples);
+  mixParam.skip(numSamples);
+  widthParam.skip(numSamples);
+}
+
+bool StereoDelay::process(juce::AudioBuffer<float> &buffer, bool inputSilent) {
+  const int numSamples = buffer.getNumSamples();
+  const int numChannels = juce::jmin(2, buffer.getNumChannels());
+
+  if (numSamples <= 0 || numChannels <= 0)
+    return false;
+
+  // Mix parked at zero: nothing can be heard, so forget what is in the lines
+  if (mixParam.getTargetValue() <= 0.0f && !mixParam.isSmoothing()) {
+    if (tailSamples > 0)
+      reset();
+    inputSilent = true;
+  }
+
+  if ((inputSilent && tailSamples <= 0) || scratch == nullptr) {
+    skip(numSamples);
+    return false;
+  }
+
+  const ScratchArena::Scope scratchScope(*scratch);
+  float *wet[2], *write[2];
+  float *fadeScratch = nullptr;
+  if (!scratch->allocateChannels(wet, 2, numSamples) ||
+      !scratch->allocateChannels(write, 2, numSamples) ||
+      (fadeScratch = scratch->allocate(numSamples)) == nullptr) {
+    skip(numSamples);
+    return false;
+  }
+
+  // Waking from silence: the lines are empty, so jump straight to the time
+  if (tailSamples <= 0) {
+    currentDelay = nextDelay = targetDelay;
+    fading = false;
+  }
+
+  float *channels[2] = {buffer.getWritePointer(0),
+                        numChannels > 1 ? buffer.getWritePointer(1) : nullptr};
+  float peak = 0.0f;
+
+  for (int done = 0; done < numSamples;) {
+    if (!fading && targetDelay != currentDelay) {
+      nextDelay = targetDelay;
+      fadePos = 0;
+      fading = true;
+    }
+
+    // A run may not read anything it hasn't written yet
+    int n = juce::jmin(numSamples - done, currentDelay);
+    if (fading)
+      n = juce::jmin(n, nextDelay, fadeLength - fadePos);
+
+    float *runChannels[2] = {channels[0] + done,
+                             channels[1] != nullptr ? channels[1] + done
+                                                    : nullptr};
+    peak = juce::jmax(peak, processChunk(runChannels, numChannels, n, wet,
+                                         write, fadeScratch));
+    done += n;
+  }
+
+  // Anything audible pushed this block comes back out within the longest tap.
+  // Once that has passed quietly, forget the lines so nothing stale is left
+  // for a later, longer delay time to find.
+  if (peak >= silenceThreshold) {
+    tailSamples = juce::jmax(currentDelay, nextDelay, targetDelay) + numSamples;
+  } else {
+    tailSamples -= numSamples;
+    if (tailSamples <= 0)
+      reset();
+  }
+
+  return true;
+}
+
+float StereoDelay::processChunk(float *const *channels, int numChannels,
+                                int numSamples, float *const *wet,
+                                float *const *write, float *fadeScratch) {
+  const float fbStart = feedbackParam.getCurrentValue();
+  const float fbEnd = feedbackParam.skip(numSamples);
+  const float mixStart = mixParam.getCurrentValue();
+  const float mixEnd = mixParam.skip(numSamples);
+  const float widthStart = widthParam.getCurrentValue();
+  const float widthEnd = widthParam.skip(numSamples);
+
+  // Taps: plain copies, blended with the incoming tap only during a fade
+  for (int ch = 0; ch < numChannels; ++ch) {
+    readTap(wet[ch], ch, currentDelay, numSamples);
+
+    if (fading) {
+      readTap(fadeScratch, ch, nextDelay, numSamples);
+      const float step = 1.0f / (float)fadeLength;
+      float g = (float)fadePos * step;
+
+      for (int i = 0; i < numSamples; ++i) {
+        g += step;
+        wet[ch][i] += (fadeScratch[i] - wet[ch][i]) * g;
+      }
+    }
+  }
+
+  if (fading) {
+    fadePos += numSamples;
+    if (fadePos >= fadeLength) {
+      currentDelay = nextDelay;
+      fading = false;
+    }
+  }
+
+  // Line inputs: straight feedback, or mono in on the left with the
+  // feedback crossed over for ping-pong
+  if (pingPongEnabled && numChannels == 2) {
+    juce::FloatVectorOperations::copyWithMultiply(write[0], channels[0], 0.5f,
+                                                  numSamples);
+    juce::FloatVectorOperations::addWithMultiply(write[0], channels[1], 0.5f,
+                                                 numSamples);
+    addWithRamp(write[0], wet[1], fbStart, fbEnd, numSamples);
+
+    juce::FloatVectorOperations::clear(write[1], numSamples);
+    addWithRamp(write[1], wet[0], fbStart, fbEnd, numSamples);
+  } else {
+    for (int ch = 0; ch < numChannels; ++ch) {
+      juce::FloatVectorOperations::copy(write[ch], channels[ch], numSamples);
+      addWithRamp(write[ch], wet[ch], fbStart, fbEnd, numSamples);
+    }
+  }
+
+  float peak = 0.0f;
+  for (int ch = 0; ch < numChannels; ++ch) {
+    writeRing(ch, write[ch], numSamples);
+
+    float lo = 0.0f, hi = 0.0f;
+    juce::FloatVectorOperations::findMinAndMax(write[ch], numSamples, lo, hi);
+    peak = juce::jmax(peak, -lo, hi);
+  }
+  writePos = (writePos + numSamples) & ringMask;
+  written = juce::jmin(written + numSamples, ringMask + 1);
+
+  // Width narrows the wet side signal (1 = as is, 0 = mono echoes)
+  if (numChannels == 2 && (widthStart < 1.0f || widthEnd < 1.0f)) {
+    const float step = (widthEnd - widthStart) / (float)numSamples;
+    float w = widthStart;
+
+    for (int i = 0; i < numSamples; ++i) {
+      w += step;
+      const float a = 0.5f * (1.0f + w);
+      const float b = 0.5f * (1.0f - w);
+      const auto frame = StereoFrame::load(wet, 2, i);
+      (frame * a + frame.swapped() * b).store(wet, 2, i);
+    }
+  }
+
+  for (int ch = 0; ch < numChannels; ++ch) {
+    if (wetOnly)
+      juce::FloatVectorOperations::clear(channels[ch], numSamples);
+    addWithRamp(channels[ch], wet[ch], mixStart, mixEnd, numSamples);
+  }
+
+  return peak;
+}
+
+void StereoDelay::readTap(float *dest, int channel, int delay,
+                          int numSamples) const {
+  // Samples from before the last reset read as silence
+  const int stale = juce::jlimit(0, numSamples, delay - written);
+  if (stale > 0) {
+    juce::FloatVectorOperations::clear(dest, stale);
+    dest += stale;
+    numSamples -= stale;
+  }
+
+  const auto &line = ring[(size_t)channel];
+  const int start = (writePos - delay + stale) & ringMask;
+  const int first = juce::jmin(numSamples, ringMask + 1 - start);
+
+  juce::FloatVectorOperations::copy(dest, line.data() + start, first);
+  if (first < numSamples)
+    juce::FloatVectorOperations::copy(dest + first, line.data(),
+                                      numSamples - first);
+}
+
+void StereoDelay::writeRing(int channel, const float *source, int numSamples) {
+  auto &line = ring[(size_t)channel];
+  const int first = juce::jmin(numSamples, ringMask + 1 - writePos);
+
+  juce::FloatVectorOperations::copy(line.data() + writePos, source, first);
+  if (first < numSamples)
+    juce::FloatVectorOperations::copy(line.data(), source + first,
+                                      numSamples - first);
+}
+
+void StereoDelay::addWithRamp(float *dest, const float *source, float start,
+                              float end, int numSamples) {
+  if (start == end) {
+    if (start != 0.0f)
+      juce::FloatVectorOperations::addWithMultiply(dest, source, start,
+                                                   numSamples);
+    return;
+  }
+
+  const float step = (end - start) / (float)numSamples;
+  float gain = start;
+
+  for (int i = 0; i < numSamples; ++i) {
+    gain += step;
+    dest[i] += source[i] * gain;
+  }
+}
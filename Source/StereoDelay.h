@@ -0,0 +1,99 @@
+#pragma once
+#include "ScratchArena.h"
+#include "StereoFrame.h"
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Block-processed stereo feedback delay.
+
+    Taps are read at whole-sample offsets, so with static settings a block is
+    a couple of ring-buffer copies plus vector multiply-adds. When the delay
+    time changes the old and new taps are crossfaded instead of sweeping an
+    interpolated read head, so there's no pitch wobble and the blend only runs
+    while the time is actually moving.
+
+    Ping-pong feeds the mono input into the left line and cross-couples the
+    feedback; width scales the side signal of the wet output.
+
+    Resetting never clears the lines (several MB at high rates); taps read
+    anything written before the reset as silence instead.
+*/
+class StereoDelay {
+public:
+  static constexpr double maxDelaySeconds = 4.0; // A 1/1 echo at 60 BPM
+
+  StereoDelay() = default;
+
+  void prepare(const juce::dsp::ProcessSpec &spec, ScratchArena &scratchArena);
+  void reset();
+
+  void setParameters(float timeSeconds, float feedback, float mix);
+  void setStereo(float width, bool pingPong);
+
+  // Runs the delay at the prepared rate divided by 1, 2 or 4. The lines are
+  // sized for the full rate, so this doesn't allocate; it does reset them.
+  void setRateDivisor(int divisor);
+
+  // Wet only: process() replaces the buffer with the mixed wet signal
+  // instead of adding it to the input
+  void setWetOnly(bool shouldBeWetOnly) { wetOnly = shouldBeWetOnly; }
+
+  // Adds the wet signal to the buffer. Returns true if it may have written
+  // anything (false while asleep on silent input).
+  bool process(juce::AudioBuffer<float> &buffer, bool inputSilent);
+
+  // Moves the smoothers on as if a silent block had been processed
+  void skip(int numSamples);
+
+  // Nothing audible left in the lines
+  bool isIdle() const { return tailSamples <= 0; }
+
+private:
+  static constexpr float silenceThreshold = 1.0e-6f;
+  static constexpr double crossfadeSeconds = 0.03;
+
+  // One run no longer than the shortest tap. Returns the peak written to the
+  // lines.
+  float processChunk(float *const *channels, int numChannels, int numSamples,
+                     float *const *wet, float *const *write,
+                     float *fadeScratch);
+  void readTap(float *dest, int channel, int delay, int numSamples) const;
+  void writeRing(int channel, const float *source, int numSamples);
+  void updateRate();
+  void updateTargetDelay();
+
+  // dest += source * gain, ramping the gain from start to end
+  static void addWithRamp(float *dest, const float *source, float start,
+                          float end, int numSamples);
+
+  double preparedRate = 44100.0;
+  double sampleRate = 44100.0; // Processing rate, after the divisor
+  int rateDivisor = 1;
+  bool wetOnly = false;
+  int maxBlockSize = 512;
+  ScratchArena *scratch = nullptr;
+
+  std::array<std::vector<float>, 2> ring;
+  int ringMask = 0;
+  int writePos = 0;
+  int written = 0; // Samples written since reset(); older ones are stale
+
+  // Tap positions in whole samples; nextDelay is faded in over fadeLength
+  float timeSeconds = 0.0f;
+  int targetDelay = 1;
+  int currentDelay = 1;
+  int nextDelay = 1;
+  int fadePos = 0;
+  int fadeLength = 1;
+  bool fading = false;
+
+  juce::LinearSmoothedValue<float> feedbackParam;
+  juce::LinearSmoothedValue<float> mixParam;
+  juce::LinearSmoothedValue<float> widthParam{1.0f};
+  bool pingPongEnabled = false;
+
+  int tailSamples = 0; // Until everything in the lines is silent
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StereoDelay)
+};
@@ -0,0 +1,201 @@
+#pragma once
+#include <JuceHeader.h>
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                   \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HOWLING_STEREO_FRAME_SSE 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define HOWLING_STEREO_FRAME_NEON 1
+#endif
+
+//==============================================================================
+/**
+    One left/right sample pair held in a SIMD register, so a stereo effect
+    does its per-sample arithmetic for both channels in one instruction
+    (SSE2 or NEON, with a plain pair of floats elsewhere).
+
+    Frames load from and store to a buffer's channel pointers. With a single
+    channel, the right lane mirrors the left and only the left is stored, so
+    mono runs through the same code.
+
+    Meant for the sample-by-sample recurrences (envelopes, holds, shapers)
+    that block-wide vector operations can't express; plain gains and mixes
+    over a block are still cheaper as FloatVectorOperations.
+*/
+class StereoFrame {
+public:
+  StereoFrame() : StereoFrame(0.0f) {}
+  StereoFrame(float both) : StereoFrame(both, both) {}
+
+#if HOWLING_STEREO_FRAME_SSE
+  StereoFrame(float left, float right) : v(_mm_setr_ps(left, right, 0, 0)) {}
+
+  float left() const { return _mm_cvtss_f32(v); }
+  float right() const { return _mm_cvtss_f32(_mm_shuffle_ps(v, v, 0x55)); }
+
+  static StereoFrame load(const float *const *channels, int numChannels,
+                          int index) {
+    const __m128 l = _mm_load_ss(channels[0] + index);
+    const __m128 r =
+        numChannels > 1 ? _mm_load_ss(channels[1] + index) : l;
+    return StereoFrame(_mm_unpacklo_ps(l, r));
+  }
+
+  void store(float *const *channels, int numChannels, int index) const {
+    _mm_store_ss(channels[0] + index, v);
+    if (numChannels > 1)
+      _mm_store_ss(channels[1] + index, _mm_shuffle_ps(v, v, 0x55));
+  }
+
+  StereoFrame swapped() const { return _mm_shuffle_ps(v, v, 0xe1); }
+
+  StereoFrame operator+(StereoFrame o) const { return _mm_add_ps(v, o.v); }
+  StereoFrame operator-(StereoFrame o) const { return _mm_sub_ps(v, o.v); }
+  StereoFrame operator*(StereoFrame o) const { return _mm_mul_ps(v, o.v); }
+
+  static StereoFrame abs(StereoFrame a) {
+    return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v);
+  }
+  static StereoFrame min(StereoFrame a, StereoFrame b) {
+    return _mm_min_ps(a.v, b.v);
+  }
+  static StereoFrame max(StereoFrame a, StereoFrame b) {
+    return _mm_max_ps(a.v, b.v);
+  }
+
+  // Nearest integer, ties to even
+  static StereoFrame round(StereoFrame a) {
+    return _mm_cvtepi32_ps(_mm_cvtps_epi32(a.v));
+  }
+
+  // Per lane: ifGreater where a > b, otherwise the other
+  static StereoFrame whereGreater(StereoFrame a, StereoFrame b,
+                                  StereoFrame ifGreater,
+                                  StereoFrame otherwise) {
+    const __m128 mask = _mm_cmpgt_ps(a.v, b.v);
+    return _mm_or_ps(_mm_and_ps(mask, ifGreater.v),
+                     _mm_andnot_ps(mask, otherwise.v));
+  }
+
+private:
+  using Native = __m128;
+#elif HOWLING_STEREO_FRAME_NEON
+  StereoFrame(float left, float right)
+      : v(vset_lane_f32(right, vdup_n_f32(left), 1)) {}
+
+  float left() const { return vget_lane_f32(v, 0); }
+  float right() const { return vget_lane_f32(v, 1); }
+
+  static StereoFrame load(const float *const *channels, int numChannels,
+                          int index) {
+    const float l = channels[0][index];
+    return StereoFrame(l, numChannels > 1 ? channels[1][index] : l);
+  }
+
+  void store(float *const *channels, int numChannels, int index) const {
+    vst1_lane_f32(channels[0] + index, v, 0);
+    if (numChannels > 1)
+      vst1_lane_f32(channels[1] + index, v, 1);
+  }
+
+  StereoFrame swapped() const { return vrev64_f32(v); }
+
+  StereoFrame operator+(StereoFrame o) const { return vadd_f32(v, o.v); }
+  StereoFrame operator-(StereoFrame o) const { return vsub_f32(v, o.v); }
+  StereoFrame operator*(StereoFrame o) const { return vmul_f32(v, o.v); }
+
+  static StereoFrame abs(StereoFrame a) { return vabs_f32(a.v); }
+  static StereoFrame min(StereoFrame a, StereoFrame b) {
+    return vmin_f32(a.v, b.v);
+  }
+  static StereoFrame max(StereoFrame a, StereoFrame b) {
+    return vmax_f32(a.v, b.v);
+  }
+
+  // Nearest integer, ties to even
+  static StereoFrame round(StereoFrame a) { return vrndn_f32(a.v); }
+
+  // Per lane: ifGreater where a > b, otherwise the other
+  static StereoFrame whereGreater(StereoFrame a, StereoFrame b,
+                                  StereoFrame ifGreater,
+                                  StereoFrame otherwise) {
+    return vbsl_f32(vcgt_f32(a.v, b.v), ifGreater.v, otherwise.v);
+  }
+
+private:
+  using Native = float32x2_t;
+#else
+  StereoFrame(float left, float right) : v{left, right} {}
+
+  float left() const { return v.l; }
+  float right() const { return v.r; }
+
+  static StereoFrame load(const float *const *channels, int numChannels,
+                          int index) {
+    const float l = channels[0][index];
+    return StereoFrame(l, numChannels > 1 ? channels[1][index] : l);
+  }
+
+  void store(float *const *channels, int numChannels, int index) const {
+    channels[0][index] = v.l;
+    if (numChannels > 1)
+      channels[1][index] = v.r;
+  }
+
+  StereoFrame swapped() const { return {v.r, v.l}; }
+
+  StereoFrame operator+(StereoFrame o) const {
+    return {v.l + o.v.l, v.r + o.v.r};
+  }
+  StereoFrame operator-(StereoFrame o) const {
+    return {v.l - o.v.l, v.r - o.v.r};
+  }
+  StereoFrame operator*(StereoFrame o) const {
+    return {v.l * o.v.l, v.r * o.v.r};
+  }
+
+  static StereoFrame abs(StereoFrame a) {
+    return {std::abs(a.v.l), std::abs(a.v.r)};
+  }
+  static StereoFrame min(StereoFrame a, StereoFrame b) {
+    return {juce::jmin(a.v.l, b.v.l), juce::jmin(a.v.r, b.v.r)};
+  }
+  static StereoFrame max(StereoFrame a, StereoFrame b) {
+    return {juce::jmax(a.v.l, b.v.l), juce::jmax(a.v.r, b.v.r)};
+  }
+
+  // Nearest integer, ties to even
+  static StereoFrame round(StereoFrame a) {
+    return {std::nearbyint(a.v.l), std::nearbyint(a.v.r)};
+  }
+
+  // Per lane: ifGreater where a > b, otherwise the other
+  static StereoFrame whereGreater(StereoFrame a, StereoFrame b,
+                                  StereoFrame ifGreater,
+                                  StereoFrame otherwise) {
+    return {a.v.l > b.v.l ? ifGreater.v.l : otherwise.v.l,
+            a.v.r > b.v.r ? ifGreater.v.r : otherwise.v.r};
+  }
+
+private:
+  struct Native {
+    float l, r;
+  };
+#endif
+
+public:
+  StereoFrame &operator+=(StereoFrame o) { return *this = *this + o; }
+  StereoFrame &operator-=(StereoFrame o) { return *this = *this - o; }
+  StereoFrame &operator*=(StereoFrame o) { return *this = *this * o; }
+
+  static StereoFrame clamp(StereoFrame a, StereoFrame lo, StereoFrame hi) {
+    return min(max(a, lo), hi);
+  }
+
+private:
+  StereoFrame(Native native) : v(native) {}
+
+  Native v;
+};
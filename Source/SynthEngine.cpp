@@ -1,5 +1,39 @@
 #include "SynthEngine.h"
 
+//==============================================================================
+// HowlingSound
+//==============================================================================
+
+void HowlingSound::prepareSampleMemory(bool lock) {
+  lockedChannels.clear();
+
+  const auto *data = getAudioData();
+  if (data == nullptr)
+    return;
+
+  const size_t channelBytes = (size_t)data->getNumSamples() * sizeof(float);
+
+  for (int ch = 0; ch < data->getNumChannels(); ++ch) {
+    const float *channel = data->getReadPointer(ch);
+
+    if (lock)
+      lockedChannels.emplace_back(channel, channelBytes);
+    else
+      LockedMemoryRegion::prefault(channel, channelBytes);
+  }
+}
+
+bool HowlingSound::isSampleMemoryLocked() const {
+  if (lockedChannels.empty())
+    return false;
+
+  for (const auto &region : lockedChannels)
+    if (!region.isLocked())
+      return false;
+
+  return true;
+}
+
 //==============================================================================
 // HowlingVoice
 //==============================================================================
@@ -28,11 +62,12 @@ void HowlingVoice::updateModADSR(float attack, float decay, float sustain,
   modTarget = target;
 }
 
-void HowlingVoice::prepare(double sampleRate, int samplesPerBlock) {
+void HowlingVoice::prepare(double sampleRate, int samplesPerBlock,
+                           ScratchArena &scratchArena, bool lockMemory) {
   juce::dsp::ProcessSpec spec;
   spec.sampleRate = sampleRate;
   spec.maximumBlockSize = samplesPerBlock;
-  spec.numChannels = 1; // Mono voice
+  spec.numChannels = 2; // Stereo-capable; mono sounds only use channel 0
 
   filter.prepare(spec);
   filter.setType(juce::dsp::StateVariableTPTFilterType::lowpass);
@@ -41,21 +76,38 @@ void HowlingVoice::prepare(double sampleRate, int samplesPerBlock) {
   lfoPhaseAcc = 0.0f;
 
   adsr.setSampleRate(sampleRate);
+  modAdsr.setSampleRate(sampleRate);
+  renderRate = 1;
+  preparedBlockSize = samplesPerBlock;
+  upsampler.setFactor(1);
 
   // Prepare crossover filter for Bass (120Hz)
   crossoverFilter.prepare(spec);
   crossoverFilter.setType(juce::dsp::LinkwitzRileyFilterType::lowpass);
   crossoverFilter.setCutoffFrequency(120.0f);
 
-  // Resize temp buffer for processing
-  tempBuffer.setSize(1, samplesPerBlock); // Mono voice
-  bassHighBuffer.setSize(1, samplesPerBlock);
+  granular.prepare(sampleRate, samplesPerBlock);
+
+  scratch = &scratchArena;
+
+  // The voice object holds the grain pool, envelopes and filter state; the
+  // pages it shares with its neighbours are only locked once
+  lockedState.clear();
+  if (lockMemory) {
+    const auto &grainScratch = granular.getScratch();
+    lockedState.reserve(2);
+    lockedState.emplace_back(this, sizeof(*this));
+    lockedState.emplace_back(grainScratch.data(),
+                             grainScratch.size() * sizeof(float));
+  }
 }
 
 void HowlingVoice::updateFilter(float cutoff, float resonance, int filterType) {
   baseCutoff = cutoff;
   baseResonance = resonance;
-  filter.setCutoffFrequency(cutoff);
+  filterMode = filterType;
+  filter.setCutoffFrequency(
+      juce::jmin(cutoff, (float)(getSampleRate() / renderRate) * 0.45f));
   filter.setResonance(resonance);
 
   switch (filterType) {
@@ -75,6 +127,10 @@ void HowlingVoice::updateFilter(float cutoff, float resonance, int filterType) {
     filter.setType(juce::dsp::StateVariableTPTFilterType::bandpass);
     isNotch = true;
     break;
+  case 4:
+    // Formant: the processor filters the summed voices instead
+    isNotch = false;
+    break;
   default:
     filter.setType(juce::dsp::StateVariableTPTFilterType::lowpass);
     isNotch = false;
@@ -100,6 +156,14 @@ void HowlingVoice::updateADSR(float attack, float decay, float sustain,
   adsr.setParameters(adsrParams);
 }
 
+void HowlingVoice::setEnvelopeCurves(float ampCurve, float modCurve) {
+  adsrParams.decayCurve = adsrParams.releaseCurve = ampCurve;
+  adsr.setParameters(adsrParams);
+
+  modAdsrParams.decayCurve = modAdsrParams.releaseCurve = modCurve;
+  modAdsr.setParameters(modAdsrParams);
+}
+
 void HowlingVoice::updateSampleParams(float tune, float sampleStart,
                                       float sampleEnd, bool loop) {
   tuneSemitones = tune;
@@ -108,6 +172,85 @@ void HowlingVoice::updateSampleParams(float tune, float sampleStart,
   isLooping = loop;
 }
 
+void HowlingVoice::updateOscillator(int wave, float level, int octave,
+                                    float newSampleLevel) {
+  oscLevel = juce::jlimit(0.0f, 1.0f, level);
+  sampleLevel = juce::jlimit(0.0f, 1.0f, newSampleLevel);
+
+  if (oscLevel <= 0.0f)
+    wave = -1;
+
+  if (wave == oscWave && octave == oscOctave)
+    return;
+
+  oscWave = wave;
+  oscOctave = octave;
+  osc.setWaveform(wave);
+
+  if (isVoiceActive())
+    updateOscillatorPitch();
+}
+
+void HowlingVoice::updateOscillatorPitch() {
+  if (!osc.isActive())
+    return;
+
+  // The note only: tune, bend, glide and pitch modulation arrive per sample
+  // through the same rates as the sample reader's
+  const double note = getCurrentlyPlayingNote() + oscOctave * 12;
+  osc.setFrequency(440.0 * std::pow(2.0, (note - 69.0) / 12.0),
+                   getSampleRate() / (double)renderRate);
+}
+
+void HowlingVoice::pitchWheelMoved(int newPitchWheelValue) {
+  pitchWheelPosition = newPitchWheelValue;
+  pitchBendSemitones =
+      (float)(newPitchWheelValue - 8192) / 8192.0f * pitchBendRange;
+}
+
+void HowlingVoice::choke() {
+  if (!isVoiceActive() || isChoking())
+    return;
+
+  chokeSamplesLeft =
+      juce::jmax(1, (int)(getSampleRate() * chokeFadeSeconds));
+  chokeGain = 1.0f;
+  chokeStep = 1.0f / (float)chokeSamplesLeft;
+}
+
+void HowlingVoice::applyChokeFade(juce::AudioBuffer<float> &buffer,
+                                  int numSamples) {
+  const int fadeSamples = juce::jmin(numSamples, chokeSamplesLeft);
+  const float endGain =
+      juce::jmax(0.0f, chokeGain - chokeStep * (float)fadeSamples);
+
+  for (int ch = 0; ch < buffer.getNumChannels(); ++ch) {
+    buffer.applyGainRamp(ch, 0, fadeSamples, chokeGain, endGain);
+    if (fadeSamples < numSamples)
+      buffer.clear(ch, fadeSamples, numSamples - fadeSamples);
+  }
+
+  chokeGain = endGain;
+  chokeSamplesLeft -= fadeSamples;
+}
+
+void HowlingVoice::setPitchParams(float glideSeconds, float bendRange) {
+  glideTime = juce::jmax(0.0f, glideSeconds);
+
+  if (bendRange != pitchBendRange) {
+    pitchBendRange = bendRange;
+    pitchWheelMoved(pitchWheelPosition);
+  }
+}
+
+void HowlingVoice::setGranularParams(const GranularEngine::Params &params,
+                                     bool forceGranular) {
+  granular.setParams(params);
+  forceGranularMode = forceGranular;
+}
+
+void HowlingVoice::setMultiRate(bool enabled) { multiRateEnabled = enabled; }
+
 void HowlingVoice::setPan(float newPan) { pan = newPan; }
 
 void HowlingVoice::setAmpVelocity(float amount01) {
@@ -115,7 +258,12 @@ void HowlingVoice::setAmpVelocity(float amount01) {
 }
 
 void HowlingVoice::setFilterDrive(float drive01) {
+  const bool wasDriven = filterDrive > 0.001f;
   filterDrive = juce::jlimit(0.0f, 1.0f, drive01);
+
+  // Don't carry stale history into the next time the drive comes on
+  if (wasDriven && filterDrive <= 0.001f)
+    driveShaper.reset();
 }
 
 void HowlingVoice::setModSmooth(float smooth01) {
@@ -133,10 +281,34 @@ void HowlingVoice::startNote(int midiNoteNumber, float velocity,
   // Check if it's Bass or One-Shot
   isCurrentSoundBass = false;
   isCurrentSoundOneShot = false;
+  isCurrentSoundGranular = false;
+  isCurrentSoundStereo = false;
+
+  currentSound = dynamic_cast<HowlingSound *>(sound);
+  sampleFinished = false;
+  chokeSamplesLeft = 0;
 
-  if (auto *hs = dynamic_cast<HowlingSound *>(sound)) {
+  if (auto *hs = currentSound) {
     isCurrentSoundBass = hs->isBassSample();
     isCurrentSoundOneShot = hs->isOneShotSample();
+    isCurrentSoundGranular = hs->isTextureSample() || forceGranularMode;
+
+    if (isCurrentSoundGranular) {
+      // Grains sustain for as long as the key is held, even for one-shots
+      isCurrentSoundOneShot = false;
+    }
+
+    // Grains are mono; sampled playback keeps the source's width
+    isCurrentSoundStereo = hs->isStereo() && !isCurrentSoundGranular;
+
+    // Source samples per output sample at the played note
+    pitchRatio = std::pow(2.0, (midiNoteNumber - hs->getRootNote()) / 12.0) *
+                 hs->getSourceSampleRate() / getSampleRate();
+    sourceSamplePosition = 0.0;
+    sourceGain = velocity; // Same level as juce::SamplerVoice
+
+    if (isCurrentSoundGranular)
+      granular.noteOn(hs->getAudioData(), hs->getLength(), pitchRatio);
   }
 
   // 1. Base startNote
@@ -145,12 +317,29 @@ void HowlingVoice::startNote(int midiNoteNumber, float velocity,
 
   crossoverFilter.reset();
 
+  // Low, dark bass notes can render at 1/2 or 1/4 rate
+  applyRenderRate(chooseRenderRate(midiNoteNumber));
+  upsampler.reset();
+
   noteVelocity = juce::jlimit(0.0f, 1.0f, velocity);
   adsr.noteOn();
   modAdsr.noteOn(); // Trigger Mod Env
   filter.reset();
+  driveShaper.reset();
   lfoPhaseAcc = 0.0f;
   smoothedModEnv = 0.0f;
+
+  // Portamento from the previous note, linear in pitch
+  glideOffset = 0.0f;
+  if (glideTime > 0.0f && glideSourceNote >= 0 &&
+      glideSourceNote != midiNoteNumber) {
+    glideOffset = (float)(glideSourceNote - midiNoteNumber);
+    glideStep = std::abs(glideOffset) / (glideTime * (float)getSampleRate());
+  }
+
+  osc.reset();
+  updateOscillatorPitch();
+  pitchWheelMoved(currentPitchWheelPosition);
 }
 
 void HowlingVoice::stopNote(float velocity, bool allowTailOff) {
@@ -171,47 +360,350 @@ void HowlingVoice::stopNote(float velocity, bool allowTailOff) {
   }
 }
 
+int HowlingVoice::readSampleData(float *destL, float *destR, int numSamples,
+                                 const float *rates, float constantStep) {
+  if (currentSound == nullptr)
+    return 0;
+
+  const auto *data = currentSound->getAudioData();
+  const float *inL = data->getReadPointer(0);
+  const float *inR = data->getNumChannels() > 1 ? data->getReadPointer(1)
+                                                : nullptr;
+  const double length = (double)currentSound->getLength();
+
+  double pos = sourceSamplePosition;
+  int i = 0;
+
+  if (destR != nullptr && inR != nullptr) {
+    // Stereo: one position/fraction per frame, both channels read together
+    for (; i < numSamples; ++i) {
+      if (pos > length) {
+        sampleFinished = true;
+        break;
+      }
+
+      const int idx = (int)pos;
+      const float alpha = (float)(pos - (double)idx);
+      destL[i] = (inL[idx] + alpha * (inL[idx + 1] - inL[idx])) * sourceGain;
+      destR[i] = (inR[idx] + alpha * (inR[idx + 1] - inR[idx])) * sourceGain;
+      pos += rates != nullptr ? rates[i] : constantStep;
+    }
+  } else {
+    for (; i < numSamples; ++i) {
+      if (pos > length) {
+        sampleFinished = true;
+        break;
+      }
+
+      const int idx = (int)pos;
+      const float alpha = (float)(pos - (double)idx);
+      float l = inL[idx] + alpha * (inL[idx + 1] - inL[idx]);
+      if (inR != nullptr)
+        l = 0.5f * (l + inR[idx] + alpha * (inR[idx + 1] - inR[idx]));
+
+      destL[i] = l * sourceGain;
+      pos += rates != nullptr ? rates[i] : constantStep;
+    }
+  }
+
+  sourceSamplePosition = pos;
+  return i;
+}
+
+// 2^x over a block, written without branches so the loop vectorises. x is
+// split into a rounded integer, built straight into the float exponent, and
+// a fraction in [-0.5, 0.5] for a 5th-order polynomial (< 4e-6 relative
+// error, far below a cent).
+static void exp2Block(float *data, int numSamples) {
+  for (int i = 0; i < numSamples; ++i) {
+    const float x = juce::jlimit(-126.0f, 126.0f, data[i]);
+    const float whole = std::floor(x + 0.5f);
+    const float f = x - whole;
+
+    const float poly =
+        1.0f +
+        f * (0.69314718f +
+             f * (0.24022651f +
+                  f * (0.05550411f + f * (0.00961813f + f * 0.00133336f))));
+
+    const std::int32_t bits = ((std::int32_t)whole + 127) << 23;
+    float scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+    data[i] = poly * scale;
+  }
+}
+
+const float *HowlingVoice::renderPlaybackRates(const float *lfo,
+                                               const float *modEnvBlock,
+                                               int numSamples,
+                                               float &constantStep) {
+  const float staticSemitones = tuneSemitones + pitchBendSemitones;
+  const float baseStep = (float)(pitchRatio * renderRate);
+  const bool pitchModulated = modTarget == 3;
+
+  constantStep = baseStep * std::exp2(staticSemitones / 12.0f);
+
+  if (!pitchModulated && glideOffset == 0.0f)
+    return nullptr;
+
+  float *rates = scratch->allocate(numSamples);
+  if (rates == nullptr)
+    return nullptr;
+
+  // Build the pitch offset in octaves, then convert to rates in one pass
+  constexpr float octavesPerSemitone = 1.0f / 12.0f;
+  const float glideDelta = glideStep * (float)renderRate;
+
+  for (int i = 0; i < numSamples; ++i) {
+    rates[i] = (staticSemitones + glideOffset) * octavesPerSemitone;
+    glideOffset = glideOffset > 0.0f
+                      ? juce::jmax(0.0f, glideOffset - glideDelta)
+                      : juce::jmin(0.0f, glideOffset + glideDelta);
+  }
+
+  if (pitchModulated) {
+    // LFO is already depth-scaled: +/-2 semitones of vibrato at full depth.
+    // The mod env sweeps up to an octave at full amount.
+    juce::FloatVectorOperations::addWithMultiply(
+        rates, lfo, lfoPitchSemitones * octavesPerSemitone, numSamples);
+    juce::FloatVectorOperations::addWithMultiply(
+        rates, modEnvBlock, modAmount * envPitchSemitones * octavesPerSemitone,
+        numSamples);
+  }
+
+  exp2Block(rates, numSamples);
+  juce::FloatVectorOperations::multiply(rates, baseStep, numSamples);
+  return rates;
+}
+
+int HowlingVoice::chooseRenderRate(int midiNoteNumber) const {
+  // The upsampler is mono, so stereo voices stay at full rate
+  if (!multiRateEnabled || !isCurrentSoundBass || isCurrentSoundGranular ||
+      isCurrentSoundStereo || currentSound == nullptr)
+    return 1;
+
+  if (midiNoteNumber < 12 || midiNoteNumber > 48)
+    return 1;
+
+  // Only a low-pass actually limits the voice bandwidth
+  if (filterMode != 0)
+    return 1;
+
+  // Highest cutoff the LFO / mod env can reach (2 octaves per unit of mod)
+  float maxMod = lfoDepth + (modTarget == 0 ? modAmount : 0.0f);
+  float bandwidth = baseCutoff * std::pow(2.0f, maxMod * 2.0f);
+
+  // Keep two octaves of 12 dB/oct roll-off below the decimated Nyquist so the
+  // low-rate reader does not fold audible content back down.
+  const double sr = getSampleRate();
+  for (int rate : {4, 2}) {
+    if (bandwidth <= (float)(sr / rate) * 0.125f)
+      return rate;
+  }
+
+  return 1;
+}
+
+void HowlingVoice::applyRenderRate(int rate) {
+  if (rate == renderRate)
+    return;
+
+  renderRate = rate;
+  const double voiceRate = getSampleRate() / (double)rate;
+
+  adsr.setSampleRate(voiceRate);
+  modAdsr.setSampleRate(voiceRate);
+
+  juce::dsp::ProcessSpec spec;
+  spec.sampleRate = voiceRate;
+  spec.maximumBlockSize = (juce::uint32)preparedBlockSize;
+  spec.numChannels = 2;
+  filter.prepare(spec);
+  filter.setCutoffFrequency(
+      juce::jmin(baseCutoff, (float)voiceRate * 0.45f));
+  filter.setResonance(baseResonance);
+
+  upsampler.setFactor(rate);
+}
+
+float HowlingVoice::shapeAndFilter(int channel, float input, float velGain,
+                                   float volGain) {
+  input *= velGain;
+
+  // Filter drive (simple saturation pre-filter)
+  if (filterDrive > 0.001f) {
+    float driveGain = 1.0f + (filterDrive * 12.0f);
+    input = driveShaper.processSample(channel, input * driveGain);
+  }
+
+  input *= volGain;
+
+  if (std::isnan(input))
+    input = 0.0f;
+  if (filterMode == 4)
+    return input;
+  float filtered = filter.processSample(channel, input);
+
+  if (isNotch) {
+    filtered = input - filtered;
+  }
+
+  // Safety Check for NaN/Infinity
+  if (std::isnan(filtered) || std::isinf(filtered)) {
+    filtered = 0.0f;
+    filter.reset();
+  }
+
+  return filtered;
+}
+
 void HowlingVoice::renderNextBlock(juce::AudioBuffer<float> &outputBuffer,
                                    int startSample, int numSamples) {
   if (!isVoiceActive())
     return;
 
-  if (tempBuffer.getNumSamples() < numSamples) {
-    tempBuffer.setSize(1, numSamples, false, false, true);
-  }
+  // Decimated voices render fewer samples into a low-rate block and are
+  // interpolated back up into tempBuffer at the end
+  const bool decimated = renderRate > 1;
+  const bool stereo = isCurrentSoundStereo; // Never decimated
+  const int numVoiceChannels = stereo ? 2 : 1;
+  const int voiceSamples =
+      decimated ? upsampler.getNumInputSamplesNeeded(numSamples) : numSamples;
+
+  // Scratch is handed back when this voice is done, so every voice reuses
+  // the same region of the arena
+  jassert(scratch != nullptr);
+  if (scratch == nullptr)
+    return;
+
+  const ScratchArena::Scope scratchScope(*scratch);
+  float *tempData = scratch->allocate(numSamples);
+  float *bufferData = decimated ? scratch->allocate(voiceSamples) : tempData;
+  float *modEnv = scratch->allocate(voiceSamples);
+  float *lfoBlock = scratch->allocate(voiceSamples);
+  float *highData =
+      isCurrentSoundBass ? scratch->allocate(numSamples) : tempData;
+
+  // Right channel only exists for stereo sounds
+  float *tempDataR = stereo ? scratch->allocate(numSamples) : tempData;
+  float *highDataR =
+      stereo && isCurrentSoundBass ? scratch->allocate(numSamples) : highData;
+
+  if (tempData == nullptr || bufferData == nullptr || modEnv == nullptr ||
+      lfoBlock == nullptr || highData == nullptr || tempDataR == nullptr ||
+      highDataR == nullptr)
+    return;
+
+  // Views over the scratch memory (channel pointers live in the buffer's
+  // preallocated space, so nothing is allocated here)
+  float *tempChannels[] = {tempData, tempDataR};
+  float *voiceChannels[] = {bufferData, tempDataR};
+  juce::AudioBuffer<float> tempBuffer(tempChannels, numVoiceChannels,
+                                      numSamples);
+  juce::AudioBuffer<float> voiceBuffer(voiceChannels, numVoiceChannels,
+                                       voiceSamples);
+
   tempBuffer.clear();
+  if (decimated)
+    juce::FloatVectorOperations::clear(bufferData, voiceSamples);
+
+  // 0. Modulation sources for the block (LFO and smoothed mod env), shared
+  // by the pitch and filter stages
+  // Global LFO values line up with the output buffer, not tempBuffer
+  if (globalLfo != nullptr) {
+    const float *sharedLfo = globalLfo + startSample;
+    for (int i = 0; i < voiceSamples; ++i)
+      lfoBlock[i] = sharedLfo[juce::jmin(i * renderRate, numSamples - 1)];
+  } else {
+    // Per-sample rates scale with the decimation factor
+    const float lfoStep = lfoIncrement * (float)renderRate;
+    for (int i = 0; i < voiceSamples; ++i) {
+      lfoBlock[i] = std::sin(lfoPhaseAcc + lfoPhaseOffset) * lfoDepth;
+      lfoPhaseAcc += lfoStep;
+      if (lfoPhaseAcc >= juce::MathConstants<float>::twoPi)
+        lfoPhaseAcc -= juce::MathConstants<float>::twoPi;
+    }
+  }
 
-  // 1. Render Raw Sample
-  juce::SamplerVoice::renderNextBlock(tempBuffer, 0, numSamples);
+  // Simple one-pole smoothing: 0=more smoothing, 1=less smoothing
+  float alpha = 0.02f + (1.0f - modSmooth) * 0.18f; // 0.02..0.20
+  alpha = juce::jmin(1.0f, alpha * (float)renderRate);
 
-  // 2. ADSR
-  adsr.applyEnvelopeToBuffer(tempBuffer, 0, numSamples);
+  modAdsr.render(modEnv, voiceSamples); // 0..1
+  for (int i = 0; i < voiceSamples; ++i) {
+    smoothedModEnv += (modEnv[i] - smoothedModEnv) * alpha;
+    modEnv[i] = smoothedModEnv;
+  }
 
-  // Calculate Mod Envelope Value (per block implies stepped, per sample is
-  // better) We'll calculate per sample for Filter/Audio targets But for
-  // optimization, let's keep it simple-ish or do per-sample loop.
+  // Pitch for the block, shared by the sample reader and the oscillator
+  float constantStep = 0.0f;
+  const float *rates =
+      renderPlaybackRates(lfoBlock, modEnv, voiceSamples, constantStep);
+
+  // 1. Render Raw Sample (or the grain cloud)
+  if (isCurrentSoundGranular) {
+    granular.render(bufferData, voiceSamples);
+  } else if (currentSound != nullptr) {
+    readSampleData(bufferData, stereo ? tempDataR : nullptr, voiceSamples,
+                   rates, constantStep);
+  }
+  else {
+    juce::SamplerVoice::renderNextBlock(tempBuffer, 0, numSamples);
+  }
 
-  auto *bufferData = tempBuffer.getWritePointer(0);
+  // The sample reader can end the note when the data runs out
+  if (!isVoiceActive())
+    return;
 
-  // 3. Filter Processing & Mod Env Application
-  for (int i = 0; i < numSamples; ++i) {
-    float lfoValue = std::sin(lfoPhaseAcc + lfoPhaseOffset);
-    lfoPhaseAcc += lfoIncrement;
-    if (lfoPhaseAcc >= juce::MathConstants<float>::twoPi)
-      lfoPhaseAcc -= juce::MathConstants<float>::twoPi;
+  // 1b. Oscillator layer, mixed before the shared filter and envelopes
+  if (sampleLevel < 1.0f)
+    voiceBuffer.applyGain(sampleLevel);
+  if (osc.isActive()) {
+    // The reader's rates over the note's own rate are the pitch ratios
+    const float baseStep = (float)(pitchRatio * renderRate);
+    float *ratios =
+        rates != nullptr ? scratch->allocate(voiceSamples) : nullptr;
+    if (ratios != nullptr)
+      juce::FloatVectorOperations::multiply(ratios, rates, 1.0f / baseStep,
+                                            voiceSamples);
+
+    const auto renderOsc = [&](float *dest) {
+      if (ratios != nullptr)
+        osc.renderAdd(dest, voiceSamples, oscLevel, ratios);
+      else
+        osc.renderAdd(dest, voiceSamples, oscLevel, constantStep / baseStep);
+    };
+
+    if (stereo) {
+      // Render once and centre it between both channels
+      if (float *oscData = scratch->allocate(voiceSamples)) {
+        juce::FloatVectorOperations::clear(oscData, voiceSamples);
+        renderOsc(oscData);
+        juce::FloatVectorOperations::add(bufferData, oscData, voiceSamples);
+        juce::FloatVectorOperations::add(tempDataR, oscData, voiceSamples);
+      }
+    } else {
+      renderOsc(bufferData);
+    }
+  }
+
+  // 2. ADSR
+  adsr.applyEnvelopeToBuffer(voiceBuffer, 0, voiceSamples);
 
-    float modEnvVal = modAdsr.getNextSample(); // 0..1
-    // Simple one-pole smoothing: 0=more smoothing, 1=less smoothing
-    float alpha = 0.02f + (1.0f - modSmooth) * 0.18f; // 0.02..0.20
-    smoothedModEnv += (modEnvVal - smoothedModEnv) * alpha;
-    modEnvVal = smoothedModEnv;
+  // 3. Filter Processing & Mod Env Application
+  const float maxCutoff =
+      decimated ? juce::jmin(20000.0f, (float)(getSampleRate() / renderRate) *
+                                           0.45f)
+                : 20000.0f;
+  for (int i = 0; i < voiceSamples; ++i) {
+    const float modEnvVal = modEnv[i];
 
     // Calculate effective LFO + Mod modulation
     // Mod Target 0: Cutoff (Default)
     // We mix LFO and Mod Env.
 
-    // Base cutoff modulation from LFO
-    float combinedMod = (lfoValue * lfoDepth);
+    // Base cutoff modulation from LFO (which moves to pitch for target 3)
+    float combinedMod = modTarget == 3 ? 0.0f : lfoBlock[i];
 
     // Add Mod Env if Target is Cutoff
     if (modTarget == 0) {
@@ -223,24 +715,16 @@ void HowlingVoice::renderNextBlock(juce::AudioBuffer<float> &outputBuffer,
 
     float modFactor = std::pow(2.0f, combinedMod * 2.0f); // 2 octaves range
     float modCutoff = baseCutoff * modFactor;
-    modCutoff = juce::jlimit(20.0f, 20000.0f, modCutoff);
+    modCutoff = juce::jlimit(20.0f, maxCutoff, modCutoff);
 
     filter.setCutoffFrequency(modCutoff);
     filter.setResonance(baseResonance);
 
-    float input = bufferData[i];
-
     // Extra velocity sensitivity control (0=flat, 1=full)
     float velGain = (1.0f - ampVelocityAmount) + (noteVelocity * ampVelocityAmount);
-    input *= velGain;
-
-    // Filter drive (simple saturation pre-filter)
-    if (filterDrive > 0.001f) {
-      float driveGain = 1.0f + (filterDrive * 12.0f);
-      input = std::tanh(input * driveGain);
-    }
 
     // Apply Mod Env to Vol/Pan/Pitch if selected
+    float volGain = 1.0f;
     if (modTarget == 1) { // Volume
       // Amount determines how much Env affects Vol
       // If amount 0, no effect. If amount 1, full effect (multiply)
@@ -250,118 +734,104 @@ void HowlingVoice::renderNextBlock(juce::AudioBuffer<float> &outputBuffer,
       // Or subtractive? Standard is Positive Mod adds, Negative (in bipolar)
       // subtracts. Here modAmount is 0-1 unipolar? Let's assume bipolar range
       // mapping or just unidirectional. User knob is 0-1. So adds volume.
-      input *= (1.0f - (modAmount * 0.5f) + (modEnvVal * modAmount));
+      volGain = 1.0f - (modAmount * 0.5f) + (modEnvVal * modAmount);
     }
 
-    // Pitch (Target 3) would need resampling rate update (expensive inside loop
-    // per sample without interpolator update) Pan (Target 2) handled at end.
-
-    if (std::isnan(input))
-      input = 0.0f;
-    float filtered = filter.processSample(0, input);
+    // Pitch (Target 3) is applied by the sample reader. Pan (Target 2)
+    // handled at end.
 
-    if (isNotch) {
-      filtered = input - filtered;
-    }
-
-    // Safety Check for NaN/Infinity
-    if (std::isnan(filtered) || std::isinf(filtered)) {
-      filtered = 0.0f;
-      filter.reset();
-    }
-
-    bufferData[i] = filtered;
+    // Both channels of a stereo voice share the coefficients set above, so
+    // the filter stays stereo-linked
+    bufferData[i] = shapeAndFilter(0, bufferData[i], velGain, volGain);
+    if (stereo)
+      tempDataR[i] = shapeAndFilter(1, tempDataR[i], velGain, volGain);
   }
 
+  // Back up to the host rate
+  if (decimated)
+    upsampler.process(bufferData, tempData, numSamples);
+
   if (!adsr.isActive()) {
     clearCurrentNote();
     return;
   }
 
-  // FORCE STOP if One-Shot and Sample has finished playing
-  // SamplerVoice::isVoiceActive() returns false when sample finishes (if not
-  // looping)
-  if (isCurrentSoundOneShot && !juce::SamplerVoice::isVoiceActive()) {
-    clearCurrentNote();
-    return;
-  }
+  // Choked voices fade out over a few ms, then free themselves below
+  const bool choking = isChoking();
+  if (choking)
+    applyChokeFade(tempBuffer, numSamples);
 
   // 4. Panning and Output Mix
+  const int numOut = outputBuffer.getNumChannels();
+
+  // Mono signals (l == r) use the constant-power pan. Stereo signals use a
+  // balance control instead, which turns down the far side rather than
+  // folding the image. Mono outputs take the average of a stereo pair.
+  auto mixPanned = [&](const float *l, const float *r) {
+    const bool isPair = l != r;
+
+    for (int ch = 0; ch < numOut; ++ch) {
+      if (numOut != 2) {
+        outputBuffer.addFrom(ch, startSample, l, numSamples,
+                             isPair ? 0.5f : 1.0f);
+        if (isPair)
+          outputBuffer.addFrom(ch, startSample, r, numSamples, 0.5f);
+      } else if (isPair) {
+        const float gain = ch == 0 ? juce::jmin(1.0f, 1.0f - pan)
+                                   : juce::jmin(1.0f, 1.0f + pan);
+        outputBuffer.addFrom(ch, startSample, ch == 0 ? l : r, numSamples,
+                             gain);
+      } else {
+        float panRad = (pan + 1.0f) * juce::MathConstants<float>::pi * 0.25f;
+        const float gain = ch == 0 ? std::cos(panRad) : std::sin(panRad);
+        outputBuffer.addFrom(ch, startSample, l, numSamples, gain);
+      }
+    }
+  };
+
   if (isCurrentSoundBass) {
     // Bass Logic: Lows (<120Hz) -> Mono, Highs -> Panned
-
-    // We can't easily do per-sample crossover efficiently here without
-    // block processing or another temp buffer, but LinkwitzRiley is per-sample
-    // capable. However, L-R is usually 2 channels (stereo). Here we have mono
-    // voice signal `tempBuffer`. We want to split it: Lows, Highs.
-
-    // Process the whole block through a filter to get Lows?
-    // But filters are stateful.
-
-    // Let's use two filters? Or process tempBuffer in place for Lows,
-    // and subtract from original to get Highs?
+    // Split with the Linkwitz-Riley low-pass and take Highs as the remainder
     // (Linkwitz-Riley sums flat).
 
-    // Copy for Highs (preallocated)
-    if (bassHighBuffer.getNumSamples() < numSamples)
-      bassHighBuffer.setSize(1, numSamples, false, false, true);
-    bassHighBuffer.makeCopyOf(tempBuffer, true);
+    // Copy for Highs (arena scratch)
+    juce::FloatVectorOperations::copy(highData, tempData, numSamples);
+    if (stereo)
+      juce::FloatVectorOperations::copy(highDataR, tempDataR, numSamples);
 
-    // Process tempBuffer (Lows)
-    juce::dsp::AudioBlock<float> block(tempBuffer);
-    // Since we only have 1 channel in tempBuffer
+    // Process tempBuffer (Lows), one or two channels
+    auto block = juce::dsp::AudioBlock<float>(tempBuffer).getSubBlock(
+        0, (size_t)numSamples);
     juce::dsp::ProcessContextReplacing<float> context(block);
     crossoverFilter.process(context);
 
-    // Now tempBuffer contains Lows.
-    // Highs = Original (bassHighBuffer) - Lows (tempBuffer)
-    bassHighBuffer.addFrom(0, 0, tempBuffer.getReadPointer(0), numSamples,
-                           -1.0f); // Subtract
+    // Highs = Original (highData) - Lows (tempBuffer)
+    juce::FloatVectorOperations::subtract(highData, tempData, numSamples);
+    if (stereo) {
+      juce::FloatVectorOperations::subtract(highDataR, tempDataR, numSamples);
 
-    // Mix to Output
-    for (int ch = 0; ch < outputBuffer.getNumChannels(); ++ch) {
-      // Pan Highs
-      float panGain = 1.0f;
-      if (outputBuffer.getNumChannels() == 2) {
-        float panRad = (pan + 1.0f) * juce::MathConstants<float>::pi * 0.25f;
-        if (ch == 0)
-          panGain = std::cos(panRad);
-        if (ch == 1)
-          panGain = std::sin(panRad);
-      }
-
-      // Mono Lows (Center panned -> equal gain 0.707 or 1.0 depending on law,
-      // let's use 1.0 for kick/sub power)
-      float bassGain = 1.0f;
-      // Actually standard constant power center is 0.707, but for sub we often
-      // want full power. Let's stick to standard pan center gain approx 0.707
-      // if we want consistency with other sounds. But typically "Mono" means
-      // equal in both.
-      bassGain = (outputBuffer.getNumChannels() == 2) ? 0.707f : 1.0f;
-
-      // Add Lows (Center)
-      outputBuffer.addFrom(ch, startSample, tempBuffer, 0, 0, numSamples,
-                           bassGain);
-
-      // Add Highs (Panned)
-      outputBuffer.addFrom(ch, startSample, bassHighBuffer, 0, 0, numSamples,
-                           panGain);
+      // Lows are kept mono
+      juce::FloatVectorOperations::add(tempData, tempDataR, numSamples);
+      juce::FloatVectorOperations::multiply(tempData, 0.5f, numSamples);
     }
+
+    // Mono Lows at the standard centre gain, for consistency with other
+    // sounds
+    const float bassGain = (numOut == 2) ? 0.707f : 1.0f;
+    for (int ch = 0; ch < numOut; ++ch)
+      outputBuffer.addFrom(ch, startSample, tempData, numSamples, bassGain);
+
+    // Add Highs (Panned)
+    mixPanned(highData, highDataR);
   } else {
     // Standard processing
-    for (int ch = 0; ch < outputBuffer.getNumChannels(); ++ch) {
-      float gain = 1.0f;
-      if (outputBuffer.getNumChannels() == 2) {
-        float panRad = (pan + 1.0f) * juce::MathConstants<float>::pi * 0.25f;
-        if (ch == 0)
-          gain = std::cos(panRad);
-        if (ch == 1)
-          gain = std::sin(panRad);
-      }
-
-      outputBuffer.addFrom(ch, startSample, tempBuffer, 0, 0, numSamples, gain);
-    }
+    mixPanned(tempData, tempDataR);
   }
+
+  // Sample data ran out this block: keep what we mixed, then free the voice
+  // (this is also what ends one-shots, which ignore stopNote)
+  if (sampleFinished || (choking && !isChoking()))
+    clearCurrentNote();
 }
 
 //==============================================================================
@@ -380,11 +850,12 @@ void SynthEngine::initialize() {
   clearSounds();
 }
 
-void SynthEngine::prepare(double sampleRate, int samplesPerBlock) {
+void SynthEngine::prepare(double sampleRate, int samplesPerBlock,
+                          ScratchArena &scratchArena, bool lockMemory) {
   setCurrentPlaybackSampleRate(sampleRate);
   for (int i = 0; i < getNumVoices(); ++i) {
     if (auto *voice = dynamic_cast<HowlingVoice *>(getVoice(i))) {
-      voice->prepare(sampleRate, samplesPerBlock);
+      voice->prepare(sampleRate, samplesPerBlock, scratchArena, lockMemory);
     }
   }
 }
@@ -434,12 +905,171 @@ void SynthEngine::updateModParams(float attack, float decay, float sustain,
   }
 }
 
+void SynthEngine::updateOscillator(int wave, float level, int octave,
+                                   float sampleLevel) {
+  for (int i = 0; i < getNumVoices(); ++i) {
+    if (auto *voice = dynamic_cast<HowlingVoice *>(getVoice(i))) {
+      voice->updateOscillator(wave, level, octave, sampleLevel);
+    }
+  }
+}
+
+void SynthEngine::setEnvelopeCurves(float ampCurve, float modCurve) {
+  for (int i = 0; i < getNumVoices(); ++i) {
+    if (auto *voice = dynamic_cast<HowlingVoice *>(getVoice(i))) {
+      voice->setEnvelopeCurves(ampCurve, modCurve);
+    }
+  }
+}
+
+void SynthEngine::setPitchParams(float glideSeconds, float bendRange) {
+  for (int i = 0; i < getNumVoices(); ++i) {
+    if (auto *voice = dynamic_cast<HowlingVoice *>(getVoice(i))) {
+      voice->setPitchParams(glideSeconds, bendRange);
+    }
+  }
+}
+
+void SynthEngine::setGranularParams(const GranularEngine::Params &params,
+                                    bool forceGranular) {
+  for (int i = 0; i < getNumVoices(); ++i) {
+    if (auto *voice = dynamic_cast<HowlingVoice *>(getVoice(i))) {
+      voice->setGranularParams(params, forceGranular);
+    }
+  }
+}
+
+void SynthEngine::setMultiRate(bool enabled) {
+  for (int i = 0; i < getNumVoices(); ++i) {
+    if (auto *voice = dynamic_cast<HowlingVoice *>(getVoice(i))) {
+      voice->setMultiRate(enabled);
+    }
+  }
+}
+
+void SynthEngine::setDriveAntialiasing(int order) {
+  const auto adaaOrder = (AdaaTanh::Order)juce::jlimit(0, 2, order);
+  for (int i = 0; i < getNumVoices(); ++i) {
+    if (auto *voice = dynamic_cast<HowlingVoice *>(getVoice(i))) {
+      voice->setDriveAntialiasing(adaaOrder);
+    }
+  }
+}
+
+void SynthEngine::setGlobalLFO(const float *lfoBlock) {
+  for (int i = 0; i < getNumVoices(); ++i) {
+    if (auto *voice = dynamic_cast<HowlingVoice *>(getVoice(i))) {
+      voice->setGlobalLFO(lfoBlock);
+    }
+  }
+}
+
+bool SynthEngine::hasActiveVoices() const {
+  for (int i = 0; i < getNumVoices(); ++i)
+    if (getVoice(i)->isVoiceActive())
+      return true;
+
+  return false;
+}
+
 void SynthEngine::setPackMode(int size, float spread) {
   packSize = size;
   packSpread = spread;
 }
 
+bool SynthEngine::restartHeldVoices(int midiChannel, int midiNoteNumber,
+                                    float velocity) {
+  bool restarted = false;
+  for (int i = 0; i < getNumVoices(); ++i) {
+    auto *voice = dynamic_cast<HowlingVoice *>(getVoice(i));
+    if (voice == nullptr || !voice->isVoiceActive() || !voice->isKeyDown() ||
+        voice->isChoking() ||
+        voice->getCurrentlyPlayingNote() != midiNoteNumber ||
+        !voice->isPlayingChannel(midiChannel))
+      continue;
+
+    // Held here so the hard stop in startVoice can't drop the last reference.
+    // The voice keeps its place in any choke group or voice limit, so those
+    // need no enforcing.
+    const auto sound = voice->getCurrentlyPlayingSound();
+    startVoice(voice, sound.get(), midiChannel, midiNoteNumber, velocity);
+    restarted = true;
+  }
+  return restarted;
+}
+
+void SynthEngine::enforceVoiceLimits(const HowlingSound &sound) {
+  const int group = sound.getChokeGroup();
+  const int maxVoices = sound.getMaxVoices();
+
+  if (group == 0 && maxVoices <= 0)
+    return;
+
+  auto playingSound = [](HowlingVoice &voice) {
+    return dynamic_cast<HowlingSound *>(
+        voice.getCurrentlyPlayingSound().get());
+  };
+
+  // Choke the whole group (including earlier hits of this sound) and count
+  // what is left of this sound
+  int numPlaying = 0;
+  for (int i = 0; i < getNumVoices(); ++i) {
+    auto *voice = dynamic_cast<HowlingVoice *>(getVoice(i));
+    if (voice == nullptr || !voice->isVoiceActive() || voice->isChoking())
+      continue;
+
+    auto *playing = playingSound(*voice);
+    if (playing == nullptr)
+      continue;
+
+    if (group != 0 && playing->getChokeGroup() == group)
+      voice->choke();
+    else if (playing == &sound)
+      ++numPlaying;
+  }
+
+  // Leave room for the new note by fading the oldest voices of this sound
+  while (maxVoices > 0 && numPlaying >= maxVoices) {
+    HowlingVoice *oldest = nullptr;
+    for (int i = 0; i < getNumVoices(); ++i) {
+      auto *voice = dynamic_cast<HowlingVoice *>(getVoice(i));
+      if (voice == nullptr || !voice->isVoiceActive() || voice->isChoking() ||
+          playingSound(*voice) != &sound)
+        continue;
+
+      if (oldest == nullptr || voice->wasStartedBefore(*oldest))
+        oldest = voice;
+    }
+
+    if (oldest == nullptr)
+      break;
+
+    oldest->choke();
+    --numPlaying;
+  }
+}
+
 void SynthEngine::noteOn(int midiChannel, int midiNoteNumber, float velocity) {
+  // A retriggered key starts over in the voice already holding it; the base
+  // class would tail that voice off and take another
+  if (restartHeldVoices(midiChannel, midiNoteNumber, velocity))
+    return;
+
+  for (int i = 0; i < getNumSounds(); ++i) {
+    auto *sound = dynamic_cast<HowlingSound *>(getSound(i).get());
+    if (sound != nullptr && sound->appliesToNote(midiNoteNumber) &&
+        sound->appliesToChannel(midiChannel))
+      enforceVoiceLimits(*sound);
+  }
+
+  // Voices glide from the last note played, whichever voice it was on
+  for (int i = 0; i < getNumVoices(); ++i) {
+    if (auto *voice = dynamic_cast<HowlingVoice *>(getVoice(i))) {
+      voice->setGlideSourceNote(lastNoteOn);
+    }
+  }
+  lastNoteOn = midiNoteNumber;
+
   // Standard note on
   // If Unison is active (packSize > 1), trigger multiple voices
 
@@ -1,5 +1,12 @@
 #pragma once
 
+#include "AdaaTanh.h"
+#include "GranularEngine.h"
+#include "LockedMemoryRegion.h"
+#include "PolyphaseInterpolator.h"
+#include "ScratchArena.h"
+#include "SegmentEnvelope.h"
+#include "WavetableOscillator.h"
 #include <JuceHeader.h>
 
 //==============================================================================
@@ -14,18 +21,55 @@ public:
                const juce::BigInteger &midiNotes, int midiNoteForNormalPitch,
                double attackTimeSecs, double releaseTimeSecs,
                double maxSampleLengthSeconds, bool isBassSound = false,
-               bool isOneShotSound = false)
+               bool isOneShotSound = false, bool isTextureSound = false)
       : juce::SamplerSound(name, source, midiNotes, midiNoteForNormalPitch,
                            attackTimeSecs, releaseTimeSecs,
                            maxSampleLengthSeconds),
-        isBass(isBassSound), isOneShot(isOneShotSound) {}
+        isBass(isBassSound), isOneShot(isOneShotSound),
+        isTexture(isTextureSound), rootNote(midiNoteForNormalPitch),
+        sourceSampleRate(source.sampleRate),
+        length(juce::jmin((int)source.lengthInSamples,
+                          (int)(maxSampleLengthSeconds * source.sampleRate))),
+        stereo(source.numChannels > 1) {}
 
   bool isBassSample() const { return isBass; }
   bool isOneShotSample() const { return isOneShot; }
+  bool isTextureSample() const { return isTexture; } // Granular by default
+
+  // SamplerSound keeps these private, so we mirror them for our own readers
+  int getRootNote() const { return rootNote; }
+  double getSourceSampleRate() const { return sourceSampleRate; }
+  int getLength() const { return length; }
+  bool isStereo() const { return stereo; }
+
+  // Voices in the same choke group (1+) cut each other off; 0 = no group.
+  // Both settings can change while the sound plays.
+  void setChokeGroup(int group) { chokeGroup = juce::jmax(0, group); }
+  int getChokeGroup() const { return chokeGroup; }
+
+  // Oldest voices of this sound are faded out past the limit; 0 = unlimited
+  void setMaxVoices(int limit) { maxVoices = juce::jmax(0, limit); }
+  int getMaxVoices() const { return maxVoices; }
+
+  // Touches the decoded sample pages so the first notes don't fault, and with
+  // lock = true also pins them in RAM (within LockedMemoryRegion's budget).
+  // Call from the loading thread before the sound reaches the synth. The
+  // last reference must be dropped off the audio thread too (SampleManager
+  // holds on to sounds it takes out of the synth until the voices let go).
+  void prepareSampleMemory(bool lock);
+  bool isSampleMemoryLocked() const;
 
 private:
   bool isBass;
   bool isOneShot;
+  bool isTexture;
+  int rootNote;
+  double sourceSampleRate;
+  int length;
+  bool stereo;
+  std::atomic<int> chokeGroup{0};
+  std::atomic<int> maxVoices{0};
+  std::vector<LockedMemoryRegion> lockedChannels;
 };
 
 //==============================================================================
@@ -45,7 +89,9 @@ public:
   // DSP Parameters
   void updateFilter(float cutoff, float resonance, int filterType);
   void updateLFO(float rate, float depth, float phase01);
-  void prepare(double sampleRate, int samplesPerBlock);
+  // lockMemory = true pins the voice's own state in RAM as well
+  void prepare(double sampleRate, int samplesPerBlock,
+               ScratchArena &scratchArena, bool lockMemory = false);
 
   // Overrides for ADSR control
   void startNote(int midiNoteNumber, float velocity,
@@ -62,12 +108,42 @@ public:
   void setModSmooth(float smooth01);
   void setLFOPhase(float phase01);
 
+  // Wavetable layer: wave -1 = Off, octave shifts relative to the played note
+  void updateOscillator(int wave, float level, int octave, float sampleLevel);
+
+  // Granular playback (always used for texture sounds, or for every sound
+  // when forced on)
+  void setGranularParams(const GranularEngine::Params &params,
+                         bool forceGranular);
+
+  // Let low bass voices render at 1/2 or 1/4 rate when their band allows it
+  void setMultiRate(bool enabled);
+
+  // Anti-aliasing for the filter drive saturator
+  void setDriveAntialiasing(AdaaTanh::Order order) {
+    driveShaper.setOrder(order);
+  }
+
+  // Portamento time (0 = off) and pitch-bend range in semitones
+  void setPitchParams(float glideSeconds, float bendRange);
+  void setGlideSourceNote(int note) { glideSourceNote = note; }
+  void pitchWheelMoved(int newPitchWheelValue) override;
+
+  // Choke groups / voice limits: fade out over a few ms, then free the voice
+  void choke();
+  bool isChoking() const { return chokeSamplesLeft > 0; }
+
+  // Shared per-block LFO (depth already applied). nullptr = per-voice LFO.
+  void setGlobalLFO(const float *lfoBlock) { globalLfo = lfoBlock; }
+
   // Override render to add post-processing (Filter)
   void renderNextBlock(juce::AudioBuffer<float> &outputBuffer, int startSample,
                        int numSamples) override;
 
   // Custom ADSR access
   void updateADSR(float attack, float decay, float sustain, float release);
+  // 0 = linear, 1 = strongly exponential decay/release segments
+  void setEnvelopeCurves(float ampCurve, float modCurve);
 
 private:
   juce::dsp::StateVariableTPTFilter<float> filter;
@@ -77,15 +153,17 @@ private:
   float lfoPhaseOffset = 0.0f;     // radians
   float lfoIncrement = 0.0f;       // radians per sample
   float lfoDepth = 0.0f;
+  const float *globalLfo = nullptr; // Indexed by output buffer sample
   float pan = 0.0f; // -1.0 (Left) to 1.0 (Right)
   float ampVelocityAmount = 1.0f; // 0..1
   float noteVelocity = 1.0f;      // 0..1 (captured at noteOn)
   float filterDrive = 0.0f;       // 0..1
+  AdaaTanh driveShaper;           // Per channel, reset when drive turns off
   float modSmooth = 0.1f;         // 0..1
   float smoothedModEnv = 0.0f;
 
-  juce::ADSR adsr;
-  juce::ADSR::Parameters adsrParams;
+  SegmentEnvelope adsr;
+  SegmentEnvelope::Parameters adsrParams;
   float lfoRate = 0.0f;
 
   // Sample Parameters
@@ -94,9 +172,71 @@ private:
   float sampleEndPercent = 1.0f;
   bool isLooping = true;
 
+  // Oscillator layer (mixed with the sample before filter/envelopes)
+  WavetableOscillator osc;
+  int oscWave = -1;
+  int oscOctave = 0;
+  float oscLevel = 0.0f;
+  float sampleLevel = 1.0f;
+
+  void updateOscillatorPitch();
+
+  // Sample reader (replaces juce::SamplerVoice's so we control the rate).
+  // With destR == nullptr a stereo source is folded down to mono. rates holds
+  // source samples per voice sample, or is nullptr to use constantStep.
+  int readSampleData(float *destL, float *destR, int numSamples,
+                     const float *rates, float constantStep);
+  HowlingSound *currentSound = nullptr;
+  double sourceSamplePosition = 0.0;
+  double pitchRatio = 1.0; // Source samples per output sample
+  float sourceGain = 1.0f;
+  bool sampleFinished = false;
+
+  // Per-sample playback rates from tune, bend, glide and pitch modulation,
+  // which the oscillator layer follows too. Returns nullptr when the rate is
+  // constant for the block.
+  const float *renderPlaybackRates(const float *lfo, const float *modEnvBlock,
+                                   int numSamples, float &constantStep);
+
+  // Pitch (semitones)
+  static constexpr float lfoPitchSemitones = 2.0f;
+  static constexpr float envPitchSemitones = 12.0f;
+  int pitchWheelPosition = 8192;
+  float pitchBendRange = 2.0f;
+  float pitchBendSemitones = 0.0f;
+  float glideTime = 0.0f; // Seconds, 0 = off
+  int glideSourceNote = -1;
+  float glideOffset = 0.0f; // Distance from the note, moves linearly to 0
+  float glideStep = 0.0f;   // Per host-rate sample
+
+  // Choke fade
+  static constexpr double chokeFadeSeconds = 0.005;
+  void applyChokeFade(juce::AudioBuffer<float> &buffer, int numSamples);
+  int chokeSamplesLeft = 0;
+  float chokeGain = 1.0f;
+  float chokeStep = 0.0f;
+
+  // Per-sample gain, drive and filter for one channel of the voice
+  float shapeAndFilter(int channel, float input, float velGain, float volGain);
+
+  // Multi-rate rendering for low-bandwidth bass voices
+  int chooseRenderRate(int midiNoteNumber) const;
+  void applyRenderRate(int rate);
+  bool multiRateEnabled = false;
+  int renderRate = 1; // 1, 2 or 4
+  int preparedBlockSize = 512;
+  int filterMode = 0;
+  PolyphaseInterpolator upsampler;
+
+  // Granular playback
+  GranularEngine granular;
+  std::vector<LockedMemoryRegion> lockedState;
+  bool forceGranularMode = false;
+  bool isCurrentSoundGranular = false;
+
   // Modulation Envelope
-  juce::ADSR modAdsr;
-  juce::ADSR::Parameters modAdsrParams;
+  SegmentEnvelope modAdsr;
+  SegmentEnvelope::Parameters modAdsrParams;
   float modAmount = 0.5f;
   int modTarget = 0; // 0=None/Filter, 1=Vol, 2=Pan, 3=Pitch
 
@@ -111,13 +251,17 @@ public: // Accessor needed for setup
   // One-Shot processing
   bool isCurrentSoundOneShot = false;
 
+  // Stereo sources keep both channels through the filter and use balance
+  // panning; everything else stays on the mono path
+  bool isCurrentSoundStereo = false;
+
   // Base parameters for modulation
   float baseCutoff = 20000.0f;
   float baseResonance = 0.1f;
   bool isNotch = false;
 
-  juce::AudioBuffer<float> tempBuffer;
-  juce::AudioBuffer<float> bassHighBuffer;
+  // Per-block temporaries come from here (owned by the processor)
+  ScratchArena *scratch = nullptr;
 
   JUCE_LEAK_DETECTOR(HowlingVoice)
 };
@@ -132,7 +276,8 @@ public:
   SynthEngine();
 
   void initialize();
-  void prepare(double sampleRate, int samplesPerBlock);
+  void prepare(double sampleRate, int samplesPerBlock,
+               ScratchArena &scratchArena, bool lockMemory = false);
 
   void updateParams(float attack, float decay, float sustain, float release,
                     float cutoff, float resonance, int filterType,
@@ -147,6 +292,27 @@ public:
   void updateSampleParams(float tune, float sampleStart, float sampleEnd,
                           bool loop);
 
+  void updateOscillator(int wave, float level, int octave, float sampleLevel);
+
+  void setEnvelopeCurves(float ampCurve, float modCurve);
+
+  void setGranularParams(const GranularEngine::Params &params,
+                         bool forceGranular);
+
+  void setMultiRate(bool enabled);
+
+  // 0 = off, 1 = first-order ADAA, 2 = second-order ADAA
+  void setDriveAntialiasing(int order);
+
+  void setPitchParams(float glideSeconds, float bendRange);
+
+  // Point every voice at a block of shared LFO values (or nullptr to fall
+  // back to each voice's free-running LFO). Must stay valid for the block.
+  void setGlobalLFO(const float *lfoBlock);
+
+  // False once every voice has finished its release
+  bool hasActiveVoices() const;
+
   // Unison (Pack Mode) parameters
   void setPackMode(int size, float spread); // size 1-8, spread 0.0-1.0
 
@@ -154,5 +320,11 @@ public:
 
 private:
   int packSize = 1;
+  int lastNoteOn = -1; // Glide source for the next note
+
+  // Choke groups and per-sound voice limits, applied before a note starts
+  void enforceVoiceLimits(const HowlingSound &sound);
+  // Restarts the voices still holding this key down; false if there are none
+  bool restartHeldVoices(int midiChannel, int midiNoteNumber, float velocity);
   float packSpread = 0.0f; // Detune and Pan spread amount
 };
@@ -5,79 +5,157 @@ TransientShaper::TransientShaper() {}
 void TransientShaper::prepare(const juce::dsp::ProcessSpec &spec) {
   sampleRate = (float)spec.sampleRate;
 
-  fastEnvs.resize(spec.numChannels);
-  slowEnvs.resize(spec.numChannels);
-
   setAttackSpeed(fastAttackMs, slowAttackMs);
   reset();
 }
 
+void TransientShaper::setMaximumLookahead(int maxSamples) {
+  for (auto &line : lookaheadLine)
+    line.assign((size_t)juce::jmax(1, maxSamples), 0.0f);
+  lookaheadSamples = juce::jmin(lookaheadSamples, maxSamples);
+  reset();
+}
+
+void TransientShaper::setLookahead(int numSamples) {
+  numSamples = juce::jlimit(0, (int)lookaheadLine[0].size(), numSamples);
+  if (numSamples == lookaheadSamples)
+    return;
+
+  lookaheadSamples = numSamples;
+  reset();
+}
+
 void TransientShaper::reset() {
-  for (auto &env : fastEnvs)
-    env.reset();
-  for (auto &env : slowEnvs)
-    env.reset();
+  fastEnv.reset();
+  slowEnv.reset();
+  stepPeak = {};
+  gain = 1.0f;
+  gainIncrement = {};
+  stepPhase = 0;
+
+  for (auto &line : lookaheadLine)
+    std::fill(line.begin(), line.begin() + lookaheadSamples, 0.0f);
+  linePos = 0;
+  quietSamples = lookaheadSamples;
 }
 
 void TransientShaper::setAttackSpeed(float fastMs, float slowMs) {
   fastAttackMs = fastMs;
   slowAttackMs = slowMs;
 
-  for (auto &env : fastEnvs)
-    env.setCoefficients(fastAttackMs, releaseMs, sampleRate);
-  for (auto &env : slowEnvs)
-    env.setCoefficients(slowAttackMs, releaseMs, sampleRate);
+  // The followers only see every detectionStep-th sample
+  const float detectionRate = sampleRate / (float)detectionStep;
+  fastEnv.setCoefficients(fastAttackMs, releaseMs, detectionRate);
+  slowEnv.setCoefficients(slowAttackMs, releaseMs, detectionRate);
+}
+
+void TransientShaper::skipSilence(int numSamples) {
+  biteAmount.skip(numSamples);
+  fastEnv.decay((float)numSamples / (float)detectionStep);
+  slowEnv.decay((float)numSamples / (float)detectionStep);
+
+  if (!isIdle()) {
+    for (auto &line : lookaheadLine)
+      std::fill(line.begin(), line.begin() + lookaheadSamples, 0.0f);
+    quietSamples = lookaheadSamples;
+  }
+}
+
+bool TransientShaper::isActive() const {
+  return lookaheadSamples > 0 ||
+         std::abs(biteAmount.getCurrentValue()) >= 0.01f ||
+         biteAmount.isSmoothing() ||
+         std::abs(biteAmount.getTargetValue()) >= 0.01f;
 }
 
-void TransientShaper::process(juce::AudioBuffer<float> &buffer) {
+bool TransientShaper::process(juce::AudioBuffer<float> &buffer,
+                              bool inputSilent) {
+  const int numSamples = buffer.getNumSamples();
+  if (inputSilent && isIdle()) {
+    skipSilence(numSamples);
+    return false;
+  }
+
   // Always process if smoothing or active
-  if (std::abs(biteAmount.getCurrentValue()) < 0.01f &&
-      !biteAmount.isSmoothing() &&
-      std::abs(biteAmount.getTargetValue()) < 0.01f)
-    return;
+  if (!isActive())
+    return false;
 
-  auto numChannels = buffer.getNumChannels();
-  auto numSamples = buffer.getNumSamples();
-
-  // Resize safety
-  if (fastEnvs.size() != numChannels) {
-    fastEnvs.resize(numChannels);
-    slowEnvs.resize(numChannels);
-    setAttackSpeed(fastAttackMs, slowAttackMs);
-    // Reset envs
-    for (auto &env : fastEnvs)
-      env.reset();
-    for (auto &env : slowEnvs)
-      env.reset();
+  quietSamples = inputSilent
+                     ? juce::jmin(quietSamples + numSamples, lookaheadSamples)
+                     : 0;
+
+  const int numChannels = juce::jmin(buffer.getNumChannels(), 2);
+  float *const *channels = buffer.getArrayOfWritePointers();
+
+  for (int start = 0; start < numSamples; start += ParameterRamp::maxLength) {
+    const int runLength =
+        juce::jmin(ParameterRamp::maxLength, numSamples - start);
+    if (biteRamp.generate(biteAmount, runLength)) {
+      processRun<true>(channels, numChannels, start, runLength,
+                       biteRamp.getRamp(runLength));
+    } else {
+      const float bite = biteRamp.getValue();
+      processRun<false>(channels, numChannels, start, runLength, &bite);
+    }
   }
+  return true;
+}
 
-  auto *ch0 = buffer.getWritePointer(0);
-  auto *ch1 = (numChannels > 1) ? buffer.getWritePointer(1) : nullptr;
+template <bool ramping>
+void TransientShaper::processRun(float *const *channels, int numChannels,
+                                 int start, int numSamples,
+                                 const float *bites) {
+  // Local copies stay in registers; the audio stores could alias members
+  auto fast = fastEnv;
+  auto slow = slowEnv;
+  auto peak = stepPeak;
+  auto currentGain = gain;
+  auto increment = gainIncrement;
+  int phase = stepPhase;
 
-  for (int i = 0; i < numSamples; ++i) {
-    float bite = biteAmount.getNextValue();
+  float *line[2] = {lookaheadLine[0].data(), lookaheadLine[1].data()};
+  const int lineLength = lookaheadSamples;
+  int pos = linePos;
 
-    // Ch 0
-    {
-      float input = ch0[i];
-      float fast = fastEnvs[0].process(input);
-      float slow = slowEnvs[0].process(input);
-      float transient = fast - slow;
-      // Boosted intensity for more noticeable "Bite"
-      float gainChange = 1.0f + (transient * bite * 6.0f);
-      gainChange = juce::jlimit(0.1f, 4.0f, gainChange);
-      ch0[i] = input * gainChange;
+  for (int i = start; i < start + numSamples; ++i) {
+    const auto input = StereoFrame::load(channels, numChannels, i);
+    peak = StereoFrame::max(peak, StereoFrame::abs(input));
+
+    // The gain is computed from input up to now and applied lineLength
+    // samples further back
+    auto output = input;
+    if (lineLength > 0) {
+      output = StereoFrame::load(line, 2, pos);
+      input.store(line, 2, pos);
+      if (++pos == lineLength)
+        pos = 0;
     }
 
-    // Ch 1
-    if (ch1) {
-      float input = ch1[i];
-      float fast = fastEnvs[1].process(input);
-      float slow = slowEnvs[1].process(input);
-      float transient = fast - slow;
-      float gainChange = 1.0f + (transient * bite * 6.0f);
-      gainChange = juce::jlimit(0.1f, 4.0f, gainChange);
-      ch1[i] = input * gainChange;
+    currentGain += increment;
+    (output * currentGain).store(channels, numChannels, i);
+
+    if (++phase == detectionStep) {
+      phase = 0;
+      if (linked)
+        peak = StereoFrame::max(peak, peak.swapped());
+
+      // Boosted intensity for more noticeable "Bite"
+      const float bite = bites[ramping ? i - start : 0];
+      const auto transient = fast.process(peak) - slow.process(peak);
+      const auto target =
+          StereoFrame::clamp(transient * (bite * 6.0f) + 1.0f, 0.1f, 4.0f);
+
+      // Reached by the end of the next step
+      increment = (target - currentGain) * (1.0f / (float)detectionStep);
+      peak = {};
     }
   }
+
+  fastEnv = fast;
+  slowEnv = slow;
+  stepPeak = peak;
+  gain = currentGain;
+  gainIncrement = increment;
+  stepPhase = phase;
+  linePos = pos;
 }
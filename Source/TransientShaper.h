@@ -1,33 +1,86 @@
 #pragma once
+#include "ParameterRamp.h"
+#include "StereoFrame.h"
 #include <JuceHeader.h>
 
+//==============================================================================
+/**
+    Boosts or softens attacks from the difference between a fast and a slow
+    envelope follower.
+
+    Detection runs on the peak of every detectionStep samples, so the
+    followers and the gain law cost a quarter of what they would per sample;
+    the gain is ramped linearly between detections. Linked, both channels
+    follow the louder one and get the same gain, so one-sided hits don't
+    pull the image around.
+
+    With a lookahead the audio is delayed behind the detector, so a boost
+    lands on the attack itself instead of a few milliseconds into it. The
+    delay is there whenever a lookahead is set, shaping or not, so the
+    latency it reports never changes with the amount.
+*/
 class TransientShaper {
 public:
+  static constexpr int detectionStep = 4;
+
   TransientShaper();
 
+  // Doesn't allocate: the oversampling switch re-prepares on the audio thread
   void prepare(const juce::dsp::ProcessSpec &spec);
   void reset();
 
-  // Process a block
-  void process(juce::AudioBuffer<float> &buffer);
+  // Sizes the lookahead line, in samples at the highest rate it will run at
+  void setMaximumLookahead(int maxSamples);
+
+  // Process a block. Returns false if it left a silent input untouched.
+  bool process(juce::AudioBuffer<float> &buffer, bool inputSilent);
+
+  // Advance over a silent block without touching audio: the output would be
+  // silent too, so only the smoother and envelope release need to move on.
+  // Anything left in the lookahead line is dropped.
+  void skipSilence(int numSamples);
+
+  // False while the amount rests at zero with no lookahead, when process()
+  // leaves audio alone
+  bool isActive() const;
+
+  // True once the lookahead line holds nothing but silence
+  bool isIdle() const { return quietSamples >= lookaheadSamples; }
 
   // Parameters
   // Amount: -1.0 (Soften) to 1.0 (Punch)
   void setAmount(float amount) { biteAmount.setTargetValue(amount); }
 
+  // Both channels share one detector (the louder side's)
+  void setStereoLink(bool shouldLink) { linked = shouldLink; }
+
+  // Delay ahead of the gain, in samples at the prepared rate (0 = off, up to
+  // the maximum). Changing it restarts the shaper.
+  void setLookahead(int numSamples);
+  int getLookahead() const { return lookaheadSamples; }
+
   // Speed definitions (optional control)
   void setAttackSpeed(float fastMs, float slowMs);
 
 private:
+  // One run of at most ParameterRamp::maxLength samples, with the amount
+  // either held (bites[0]) or ramping (one per sample)
+  template <bool ramping>
+  void processRun(float *const *channels, int numChannels, int start,
+                  int numSamples, const float *bites);
+
   float sampleRate = 44100.0f;
   juce::LinearSmoothedValue<float> biteAmount;
+  ParameterRamp biteRamp;
+  bool linked = true;
 
   // Envelope followers
   // We can use simple one-pole filters for envelopes logic
   // env = prev + coeff * (in - prev)
+  // Both channels are followed at once, one per lane, at the detection rate.
 
   struct EnvelopeFollower {
-    float value = 0.0f;
+    StereoFrame value;
     float attackCoeff = 0.0f;
     float releaseCoeff = 0.0f;
 
@@ -36,21 +89,36 @@ private:
       releaseCoeff = std::exp(-1000.0f / (releaseMsArg * sr));
     }
 
-    float process(float input) {
-      float absIn = std::abs(input);
-      if (absIn > value)
-        value = attackCoeff * value + (1.0f - attackCoeff) * absIn;
-      else
-        value = releaseCoeff * value + (1.0f - releaseCoeff) * absIn;
+    // Takes a rectified (peak) input
+    StereoFrame process(StereoFrame level) {
+      const auto coeff =
+          StereoFrame::whereGreater(level, value, attackCoeff, releaseCoeff);
+      value = level + (value - level) * coeff;
       return value;
     }
 
-    void reset() { value = 0.0f; }
+    void reset() { value = {}; }
+
+    // Same as numSteps calls to process(0.0f)
+    void decay(float numSteps) {
+      value *= std::pow(releaseCoeff, numSteps);
+    }
   };
 
-  // Per-channel state
-  std::vector<EnvelopeFollower> fastEnvs;
-  std::vector<EnvelopeFollower> slowEnvs;
+  EnvelopeFollower fastEnv;
+  EnvelopeFollower slowEnv;
+
+  // Detection state carried between blocks
+  StereoFrame stepPeak;      // Peak so far in the current step
+  StereoFrame gain{1.0f};    // Applied to the latest sample
+  StereoFrame gainIncrement; // Per sample, towards the last detection
+  int stepPhase = 0;
+
+  // Lookahead line, one per channel
+  std::array<std::vector<float>, 2> lookaheadLine;
+  int lookaheadSamples = 0;
+  int linePos = 0;
+  int quietSamples = 0; // Silent samples written since the last sound
 
   float fastAttackMs = 2.0f;
   float slowAttackMs = 20.0f; // Difference defines transient width
@@ -0,0 +1,192 @@
+#include "WavetableOscillator.h"
+
+//==============================================================================
+// WavetableBank
+//==============================================================================
+
+WavetableBank::WavetableBank() {
+  tables.resize((size_t)(NumWaveforms * numMipLevels * (tableSize + 1)), 0.0f);
+
+  for (int wave = 0; wave < NumWaveforms; ++wave)
+    generate(wave);
+}
+
+const float *WavetableBank::getTable(int wave, int mipLevel) const {
+  wave = juce::jlimit(0, NumWaveforms - 1, wave);
+  mipLevel = juce::jlimit(0, numMipLevels - 1, mipLevel);
+  return tables.data() +
+         (size_t)((wave * numMipLevels + mipLevel) * (tableSize + 1));
+}
+
+int WavetableBank::getMipLevelFor(double cyclesPerSample) {
+  // Level k is safe while (1024 >> k) * f < sr / 2, i.e. 2^k >= 2048 * inc
+  double needed = 2048.0 * std::abs(cyclesPerSample);
+  if (needed <= 1.0)
+    return 0;
+
+  int level = (int)std::ceil(std::log2(needed));
+  return juce::jlimit(0, numMipLevels - 1, level);
+}
+
+void WavetableBank::generate(int wave) {
+  // One-cycle sine lookup keeps the additive build fast:
+  // sin(2*pi*h*n/N) == sinTable[(h*n) mod N]
+  std::vector<float> sinTable((size_t)tableSize);
+  for (int n = 0; n < tableSize; ++n)
+    sinTable[(size_t)n] = (float)std::sin(juce::MathConstants<double>::twoPi *
+                                          n / (double)tableSize);
+
+  float peak = 0.0f;
+
+  for (int level = 0; level < numMipLevels; ++level) {
+    auto *table = tables.data() +
+                  (size_t)((wave * numMipLevels + level) * (tableSize + 1));
+    const int maxHarmonic = (tableSize / 2) >> level;
+
+    for (int h = 1; h <= maxHarmonic; ++h) {
+      float amp = 0.0f;
+      switch (wave) {
+      case Sine:
+        amp = (h == 1) ? 1.0f : 0.0f;
+        break;
+      case Saw:
+        amp = ((h & 1) ? 1.0f : -1.0f) / (float)h;
+        break;
+      case Square:
+        amp = (h & 1) ? 1.0f / (float)h : 0.0f;
+        break;
+      case Triangle:
+        amp = (h & 1) ? (((h >> 1) & 1) ? -1.0f : 1.0f) / (float)(h * h)
+                      : 0.0f;
+        break;
+      default:
+        break;
+      }
+
+      if (amp == 0.0f)
+        continue;
+
+      for (int n = 0; n < tableSize; ++n)
+        table[n] += amp * sinTable[(size_t)((h * n) & (tableSize - 1))];
+    }
+
+    table[tableSize] = table[0];
+
+    // Normalise against the full-band table so all levels match in loudness
+    if (level == 0)
+      peak = juce::FloatVectorOperations::findMaximum(table, tableSize);
+  }
+
+  // findMaximum ignores the negative half; the shapes are symmetric anyway
+  if (peak > 0.0f) {
+    for (int level = 0; level < numMipLevels; ++level) {
+      auto *table = tables.data() +
+                    (size_t)((wave * numMipLevels + level) * (tableSize + 1));
+      juce::FloatVectorOperations::multiply(table, 1.0f / peak, tableSize + 1);
+    }
+  }
+}
+
+//==============================================================================
+// WavetableOscillator
+//==============================================================================
+
+void WavetableOscillator::setWaveform(int wave) {
+  waveform = (wave >= 0 && wave < WavetableBank::NumWaveforms) ? wave : -1;
+}
+
+void WavetableOscillator::setFrequency(double frequencyHz, double sampleRate) {
+  if (sampleRate <= 0.0)
+    return;
+
+  baseCycles = juce::jmax(0.0, frequencyHz / sampleRate);
+}
+
+juce::uint32 WavetableOscillator::toIncrement(double cyclesPerSample) {
+  return (juce::uint32)std::llround(juce::jlimit(0.0, 0.5, cyclesPerSample) *
+                                    4294967296.0);
+}
+
+const float *WavetableOscillator::getTableFor(double cyclesPerSample) const {
+  return bank->getTable(waveform,
+                        WavetableBank::getMipLevelFor(
+                            juce::jlimit(0.0, 0.5, cyclesPerSample)));
+}
+
+void WavetableOscillator::mixChunk(float *dest, const juce::uint32 *phases,
+                                   int numSamples, float gain,
+                                   const float *table) const {
+  constexpr juce::uint32 fractionMask = (1u << fractionBits) - 1;
+  constexpr float fractionScale = 1.0f / (float)(1u << fractionBits);
+
+  alignas(16) int fractions[chunkSize];
+  alignas(16) float a[chunkSize], b[chunkSize], frac[chunkSize];
+
+  // Gather the two table points around each phase: the only scalar part
+  for (int i = 0; i < numSamples; ++i) {
+    const juce::uint32 idx = phases[i] >> fractionBits;
+    a[i] = table[idx];
+    b[i] = table[idx + 1];
+    fractions[i] = (int)(phases[i] & fractionMask);
+  }
+
+  // dest += gain * (a + frac * (b - a))
+  juce::FloatVectorOperations::convertFixedToFloat(frac, fractions,
+                                                   fractionScale, numSamples);
+  juce::FloatVectorOperations::subtract(b, a, numSamples);
+  juce::FloatVectorOperations::multiply(b, frac, numSamples);
+  juce::FloatVectorOperations::add(b, a, numSamples);
+  juce::FloatVectorOperations::addWithMultiply(dest, b, gain, numSamples);
+}
+
+void WavetableOscillator::renderAdd(float *dest, int numSamples, float gain,
+                                    float ratio) {
+  if (!isActive() || numSamples <= 0)
+    return;
+
+  const double cycles = baseCycles * ratio;
+  const float *table = getTableFor(cycles);
+  const juce::uint32 increment = toIncrement(cycles);
+
+  // Lane i of a chunk sits i increments past the chunk's start
+  alignas(16) juce::uint32 offsets[chunkSize], phases[chunkSize];
+  for (int i = 0; i < chunkSize; ++i)
+    offsets[i] = increment * (juce::uint32)i;
+
+  for (int start = 0; start < numSamples; start += chunkSize) {
+    const int n = juce::jmin(chunkSize, numSamples - start);
+    for (int i = 0; i < n; ++i)
+      phases[i] = phase + offsets[i];
+
+    mixChunk(dest + start, phases, n, gain, table);
+    phase += increment * (juce::uint32)n;
+  }
+}
+
+void WavetableOscillator::renderAdd(float *dest, int numSamples, float gain,
+                                    const float *ratios) {
+  if (!isActive() || numSamples <= 0)
+    return;
+
+  const float maxRatio =
+      juce::FloatVectorOperations::findMaximum(ratios, numSamples);
+  const float *table = getTableFor(baseCycles * maxRatio);
+  const auto scale = (float)(baseCycles * 4294967296.0);
+
+  alignas(16) juce::uint32 phases[chunkSize];
+
+  for (int start = 0; start < numSamples; start += chunkSize) {
+    const int n = juce::jmin(chunkSize, numSamples - start);
+
+    // The phases carry from sample to sample, a running sum of the
+    // increments; capped at Nyquist, which 2^31 is
+    for (int i = 0; i < n; ++i) {
+      phases[i] = phase;
+      const float increment =
+          juce::jmin(2147483648.0f, scale * ratios[start + i]);
+      phase += (juce::uint32)juce::jmax(0.0f, increment);
+    }
+
+    mixChunk(dest + start, phases, n, gain, table);
+  }
+}
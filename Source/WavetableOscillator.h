@@ -0,0 +1,86 @@
+#pragma once
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Band-limited, mip-mapped single-cycle tables shared by every oscillator.
+    Built once (additively) when the first voice is created, so nothing is
+    generated on the audio thread. Mip level k holds 1024 >> k harmonics.
+*/
+class WavetableBank {
+public:
+  enum Waveform { Sine = 0, Saw, Square, Triangle, NumWaveforms };
+
+  static constexpr int tableSize = 2048;
+  static constexpr int numMipLevels = 11;
+
+  WavetableBank();
+
+  // Each table has tableSize + 1 samples (last one wraps for interpolation)
+  const float *getTable(int wave, int mipLevel) const;
+
+  // Picks the richest table whose top harmonic stays below Nyquist for a
+  // phase increment given in cycles per sample.
+  static int getMipLevelFor(double cyclesPerSample);
+
+private:
+  void generate(int wave);
+
+  std::vector<float> tables; // [wave][mip][tableSize + 1]
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WavetableBank)
+};
+
+//==============================================================================
+/**
+    Per-voice wavetable oscillator layered under the sample. Adds into the
+    voice buffer so it shares the voice's filter and envelopes.
+
+    Each voice renders its own oscillator; running several voices side by
+    side in SIMD lanes is still an open request. Voices differ in length,
+    render rate and routing, so they would need regrouping first.
+*/
+class WavetableOscillator {
+public:
+  WavetableOscillator() = default;
+
+  void setWaveform(int wave); // -1 = Off, otherwise WavetableBank::Waveform
+  bool isActive() const { return waveform >= 0; }
+
+  // The base pitch, which renderAdd scales by a frequency ratio
+  void setFrequency(double frequencyHz, double sampleRate);
+  void reset() { phase = 0; }
+
+  // dest[i] += gain * osc at ratio times the base frequency. Renders in
+  // chunks: the table reads of a chunk are gathered, then the interpolation
+  // and mix run as vector operations.
+  void renderAdd(float *dest, int numSamples, float gain, float ratio = 1.0f);
+
+  // As above with a ratio per sample (glide, vibrato, pitch envelopes). The
+  // table is the one that stays band-limited at the block's highest pitch.
+  void renderAdd(float *dest, int numSamples, float gain,
+                 const float *ratios);
+
+private:
+  // Phase as a fraction of a cycle in 32-bit fixed point, so it wraps by
+  // itself: the top bits index the table, the rest are the fraction
+  static constexpr int fractionBits = 32 - 11;
+  static_assert((1 << (32 - fractionBits)) == WavetableBank::tableSize,
+                "index bits must cover the table");
+  static constexpr int chunkSize = 64;
+
+  // Cycles per sample as a phase increment, capped at Nyquist
+  static juce::uint32 toIncrement(double cyclesPerSample);
+  const float *getTableFor(double cyclesPerSample) const;
+  // The gather, then the interpolation and mix, for one chunk of phases
+  void mixChunk(float *dest, const juce::uint32 *phases, int numSamples,
+                float gain, const float *table) const;
+
+  juce::SharedResourcePointer<WavetableBank> bank;
+
+  int waveform = -1;
+  juce::uint32 phase = 0;
+  double baseCycles = 0.0; // Per output sample, at a ratio of 1
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WavetableOscillator)
+};
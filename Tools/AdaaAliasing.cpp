@@ -0,0 +1,102 @@
+// Measures how much aliasing the distortion's tanh shaper folds back, with
+// and without antiderivative anti-aliasing, and what each order costs.
+//
+// A sine with a whole number of cycles in the FFT frame is driven into the
+// shaper; every bin that isn't one of its harmonics holds folded-back
+// energy, so the ratio of that to the fundamental is the aliasing figure.
+// The tones are prime bin numbers so no folded harmonic lands on a true one.
+//
+//   cmake -B build -DHOWLING_WOLVES_TOOLS=ON
+//   cmake --build build --target AdaaAliasing
+
+#include "AdaaTanh.h"
+#include <JuceHeader.h>
+#include <chrono>
+#include <cstdio>
+
+namespace {
+constexpr int fftOrder = 16;
+constexpr int fftSize = 1 << fftOrder;
+constexpr int settleSamples = 4096; // Let the shaper history fill first
+constexpr double sampleRate = 44100.0;
+
+template <typename Shaper>
+std::vector<float> render(Shaper &&shaper, int bin, float drive) {
+  std::vector<float> output(settleSamples + fftSize);
+  for (size_t i = 0; i < output.size(); ++i) {
+    const double phase = juce::MathConstants<double>::twoPi * (double)bin *
+                         (double)i / (double)fftSize;
+    output[i] = shaper(0.5f * drive * (float)std::sin(phase));
+  }
+  output.erase(output.begin(), output.begin() + settleSamples);
+  return output;
+}
+
+// Aliased power relative to the fundamental, in dB
+double measureAliasing(const std::vector<float> &signal, int bin) {
+  juce::dsp::FFT fft(fftOrder);
+  std::vector<float> data(2 * fftSize, 0.0f);
+  std::copy(signal.begin(), signal.end(), data.begin());
+  fft.performFrequencyOnlyForwardTransform(data.data());
+
+  double aliased = 0.0;
+  for (int k = 1; k < fftSize / 2; ++k)
+    if (k % bin != 0)
+      aliased += (double)data[(size_t)k] * (double)data[(size_t)k];
+
+  const double fundamental = (double)data[(size_t)bin] * data[(size_t)bin];
+  return 10.0 * std::log10(aliased / fundamental);
+}
+
+template <typename Shaper> double nanosecondsPerSample(Shaper &&shaper) {
+  constexpr int numSamples = 1 << 20;
+  std::vector<float> input(numSamples);
+  for (int i = 0; i < numSamples; ++i)
+    input[(size_t)i] = 20.0f * std::sin((float)i * 0.37f);
+
+  float sum = 0.0f; // Keeps the calls from being optimised away
+  const auto start = std::chrono::steady_clock::now();
+  for (float x : input)
+    sum += shaper(x);
+  const std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  if (sum == 12345.0f)
+    std::printf(" ");
+  return elapsed.count() / numSamples;
+}
+} // namespace
+
+int main() {
+  struct Variant {
+    const char *name;
+    AdaaTanh::Order order;
+  };
+  const Variant variants[] = {{"tanh", AdaaTanh::Order::Off},
+                              {"ADAA 1st", AdaaTanh::Order::First},
+                              {"ADAA 2nd", AdaaTanh::Order::Second}};
+
+  for (int bin : {1931, 7919}) {
+    for (float drive : {10.0f, 50.0f}) {
+      std::printf("%.0f Hz, drive %.0f\n", bin * sampleRate / fftSize, drive);
+      for (const auto &variant : variants) {
+        AdaaTanh shaper;
+        shaper.setOrder(variant.order);
+        const auto output = render(
+            [&](float x) { return shaper.processSample(0, x); }, bin, drive);
+        std::printf("  %-9s aliasing %6.1f dB\n", variant.name,
+                    measureAliasing(output, bin));
+      }
+    }
+  }
+
+  std::printf("Cost\n");
+  for (const auto &variant : variants) {
+    AdaaTanh shaper;
+    shaper.setOrder(variant.order);
+    std::printf("  %-9s %5.1f ns/sample\n", variant.name,
+                nanosecondsPerSample(
+                    [&](float x) { return shaper.processSample(0, x); }));
+  }
+  return 0;
+}
@@ -0,0 +1,142 @@
+// Times the FDN reverb's quality tiers against the Freeverb it replaced
+// (juce::dsp::Reverb, with the settings the effect used to map onto it) and
+// measures the decay time each one actually produces.
+//
+// Every reverb renders the same minute of stereo noise bursts in host-sized
+// blocks; the cost is the best of several passes, as a share of one core in
+// real time. The decay comes from the slope of the impulse response energy
+// from the 0.2 s window to the 1 s one.
+//
+//   cmake -B build -DHOWLING_WOLVES_TOOLS=ON -DCMAKE_BUILD_TYPE=Release
+//   cmake --build build --target ReverbBenchmark
+
+#include "FdnReverb.h"
+#include <JuceHeader.h>
+#include <chrono>
+#include <cstdio>
+
+namespace {
+constexpr double sampleRate = 48000.0;
+constexpr int blockSize = 256;
+constexpr int numPasses = 5;
+constexpr float size = 0.5f, decay = 0.5f, damping = 0.5f;
+
+juce::dsp::ProcessSpec makeSpec() { return {sampleRate, blockSize, 2}; }
+
+struct Freeverb {
+  juce::dsp::Reverb reverb;
+
+  Freeverb() {
+    reverb.prepare(makeSpec());
+    juce::dsp::Reverb::Parameters params;
+    params.roomSize = decay;
+    params.damping = damping;
+    params.wetLevel = 1.0f;
+    params.dryLevel = 0.0f;
+    params.width = size;
+    reverb.setParameters(params);
+  }
+
+  void process(juce::AudioBuffer<float> &buffer, bool) {
+    juce::dsp::AudioBlock<float> block(buffer);
+    reverb.process(juce::dsp::ProcessContextReplacing<float>(block));
+  }
+};
+
+struct Fdn {
+  FdnReverb reverb;
+
+  explicit Fdn(FdnReverb::Quality quality) {
+    reverb.prepare(makeSpec());
+    reverb.setQuality(quality);
+    reverb.setParameters(size, decay, damping, 1.0f);
+
+    // Let the mix smoother reach full wet before anything is measured
+    juce::AudioBuffer<float> settle(2, blockSize);
+    for (int i = 0; i < 100; ++i) {
+      settle.clear();
+      reverb.process(settle, true);
+    }
+    reverb.reset();
+  }
+
+  void process(juce::AudioBuffer<float> &buffer, bool silent) {
+    reverb.process(buffer, silent);
+  }
+};
+
+// Share of one core, best of numPasses
+template <typename Reverb> double measureLoad(Reverb &reverb) {
+  constexpr int numBlocks = (int)(60.0 * sampleRate) / blockSize;
+  juce::AudioBuffer<float> buffer(2, blockSize);
+  juce::Random random(1);
+  double best = 1.0e9;
+
+  for (int pass = 0; pass < numPasses; ++pass) {
+    double seconds = 0.0;
+    for (int b = 0; b < numBlocks; ++b) {
+      // A 50 ms burst every second, so the tail rings most of the time
+      const bool burst = (b * blockSize) % (int)sampleRate < 2400;
+      for (int ch = 0; ch < 2; ++ch)
+        for (int i = 0; i < blockSize; ++i)
+          buffer.setSample(ch, i, burst ? random.nextFloat() - 0.5f : 0.0f);
+
+      const auto start = std::chrono::steady_clock::now();
+      reverb.process(buffer, !burst);
+      seconds += std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+    }
+    best = std::min(best, seconds);
+  }
+  return 100.0 * best / 60.0;
+}
+
+// RT60 from the energy decay of the impulse response
+template <typename Reverb> double measureDecaySeconds(Reverb &reverb) {
+  constexpr int windowSamples = 4800; // 100 ms
+  constexpr int numWindows = 12;
+  std::vector<double> energy(numWindows, 0.0);
+  juce::AudioBuffer<float> buffer(2, blockSize);
+
+  for (int b = 0; b * blockSize < numWindows * windowSamples; ++b) {
+    buffer.clear();
+    if (b == 0) {
+      buffer.setSample(0, 0, 1.0f);
+      buffer.setSample(1, 0, 1.0f);
+    }
+    reverb.process(buffer, b != 0);
+
+    for (int i = 0; i < blockSize; ++i) {
+      const int window = (b * blockSize + i) / windowSamples;
+      const float left = buffer.getSample(0, i);
+      const float right = buffer.getSample(1, i);
+      if (window < numWindows)
+        energy[(size_t)window] += left * left + right * right;
+    }
+  }
+
+  // Windows 2 and 10 are 0.8 s apart
+  const double dbPerSecond = 10.0 * std::log10(energy[10] / energy[2]) / 0.8;
+  return -60.0 / dbPerSecond;
+}
+
+template <typename Reverb, typename... Args>
+void report(const char *name, Args... args) {
+  Reverb timed(args...);
+  const double load = measureLoad(timed);
+  Reverb impulse(args...);
+  std::printf("  %-18s %6.3f %% of a core   RT60 %5.2f s\n", name, load,
+              measureDecaySeconds(impulse));
+}
+} // namespace
+
+int main() {
+  std::printf("%.0f Hz, %d-sample blocks, size %.1f decay %.1f damping %.1f\n",
+              sampleRate, blockSize, size, decay, damping);
+  report<Freeverb>("Freeverb");
+  report<Fdn>("FDN Eco", FdnReverb::Quality::Eco);
+  report<Fdn>("FDN Standard", FdnReverb::Quality::Standard);
+  report<Fdn>("FDN High", FdnReverb::Quality::High);
+  return 0;
+}